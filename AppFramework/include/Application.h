@@ -1,6 +1,42 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include <PipelineCache.h>
+#include <PipelineBuilder.h>
+#include <AssetArchive.h>
+#include <ShaderLibrary.h>
+#include <LayoutCache.h>
+#include <BindlessHeap.h>
+#include <MemoryAllocator.h>
+#include <UploadEngine.h>
+#include <GpuProfiler.h>
+#include <CpuTrace.h>
+#include <Timeline.h>
+#include <CommandRecorder.h>
+#include <JobSystem.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// CPU side timings of a finished Run(), averages and maximum cover every frame and percentiles the latest 16384
+struct FrameStats {
+	uint64_t frames = 0;
+	double seconds = 0;
+	// From entering Run() until the first frame was submitted
+	double startupMs = 0;
+	double cpuAvgMs = 0;
+	double cpuP50Ms = 0;
+	double cpuP95Ms = 0;
+	double cpuP99Ms = 0;
+	double cpuMaxMs = 0;
+	// Average time per frame the CPU sat blocked on the GPU, shrinks as more frames are allowed in flight
+	double gpuWaitMs = 0;
+	// From sampling input for a frame until the GPU finished rendering it
+	double latencyAvgMs = 0;
+	double latencyP99Ms = 0;
+};
 
 #ifndef SDL_h_
 typedef struct SDL_Window SDL_Window;
@@ -9,13 +45,88 @@ typedef struct SDL_Window SDL_Window;
 class Application {
 public:
 	virtual void OnCreate() = 0;
+	// With PipelinedUpdate set this runs on a job thread while the previous frame renders,
+	// so it may only write the GetUpdateSnapshot() state and call the thread safe services
 	virtual void OnUpdate(float dt) = 0;
 	virtual void OnRender() = 0;
+	// Called once the device is idle, before the framework tears down its own objects
+	virtual void OnDestroy() {}
+	// Called after the swapchain was rebuilt for a new window size, GetExtent already returns the new size
+	virtual void OnResize(uint32_t width, uint32_t height) {}
 	void Run();
+	const FrameStats& GetFrameStats() const;
+	// Copies of per frame state an application keeps, OnUpdate writes one while OnRender reads another
+	static constexpr uint32_t SNAPSHOT_COUNT = 2;
 protected:
 	uint32_t Width = 800;
 	uint32_t Height = 600;
 	const char* Title = "Application";
+	// Renders into a ring of offscreen images instead of a window swapchain
+	bool Headless = false;
+	// Stops the loop after this many frames, 0 runs until closed
+	uint64_t MaxFrames = 0;
+	// Frames the CPU may record ahead of the GPU, clamped to 1-4
+	uint32_t FramesInFlight = 2;
+	// Falls back to FIFO, the only mode every surface supports, when the requested one is missing
+	VkPresentModeKHR PresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	// Waits for the GPU to finish the previous frame before sampling input, trading throughput for latency
+	bool LowLatency = false;
+	// Caps the frame rate with a high resolution sleep before input is sampled, 0 runs uncapped
+	double TargetFps = 0.0;
+	// Runs OnUpdate for the next frame alongside OnRender of this one, hiding update cost for one frame of latency
+	bool PipelinedUpdate = false;
+	// Where compiled pipelines are kept between runs, an empty path always starts cold and saves nothing
+	const char* PipelineCachePath = "pipeline_cache.bin";
+	// Packed assets built by AssetPacker, shader loads look here first. A missing archive falls back to loose files
+	const char* AssetArchivePath = "assets.pak";
+	// Slots of the bindless heap, clamped to the device limits. The heap is skipped when either is 0 or the device lacks descriptor indexing
+	uint32_t BindlessImages = 16384;
+	uint32_t BindlessBuffers = 16384;
+	// Per scope GPU timings are written here on exit, as JSON for a .json path and CSV otherwise
+	const char* GpuProfilePath = nullptr;
+	// Enables TRACE_ZONE recording and writes a Chrome trace-event JSON file here on exit
+	const char* CpuTracePath = nullptr;
+	void Close();
+	VkDevice GetDevice() const;
+	VkRenderPass GetRenderPass() const;
+	VkExtent2D GetExtent() const;
+	// Pass to every vkCreate*Pipelines call so compiled pipelines are shared and persisted
+	VkPipelineCache GetPipelineCache() const;
+	// Compiles pipelines in parallel against the shared pipeline cache
+	PipelineBuilder& GetPipelineBuilder();
+	// Maps SPIR-V files and shares one module per distinct shader, modules live until shutdown
+	ShaderLibrary& GetShaderLibrary();
+	// Layouts built from reflected shaders, get the reflections from GetShaderLibrary().GetReflection(). Layouts live until shutdown
+	LayoutCache& GetLayoutCache();
+	// Sampled images and storage buffers addressed by index, not ready when the device has no descriptor indexing. Release slots before OnDestroy returns
+	BindlessHeap& GetBindless();
+	// Closed when AssetArchivePath did not open, assets are mapped and only read from disk on first use
+	const AssetArchive& GetAssets() const;
+	// Sub-allocates buffer and image memory, free everything taken from it in OnDestroy
+	MemoryAllocator& GetAllocator();
+	// Streams data to the GPU from any thread, finished uploads are picked up by the next frame
+	UploadEngine& GetUploadEngine();
+	// Times named scopes recorded in OnRender, the whole frame is measured as "Frame"
+	GpuProfiler& GetGpuProfiler();
+	// Every graphics submit signals the next value, wait on it or key recycling off it from any thread
+	Timeline& GetGraphicsTimeline();
+	// Work-stealing workers on every core but this one, Wait and ParallelFor make the calling thread help
+	JobSystem& GetJobSystem();
+	// Runs release once the GPU has finished the frame being recorded, for resources that frame still reads
+	void ReleaseAfterFrame(std::function<void()> release);
+	// Seconds between the last two frames, at full performance counter resolution
+	double GetDeltaTime() const;
+	// Milliseconds from sampling input to the GPU finishing the frame, for the latest frame measured
+	double GetInputLatency() const;
+	// Only valid inside OnUpdate, the snapshot this update writes. The other one holds the previous update and may only be read
+	uint32_t GetUpdateSnapshot() const;
+	// Only valid inside OnRender, the snapshot written by the update of the frame being rendered
+	uint32_t GetRenderSnapshot() const;
+	// Only valid inside OnRender, the first call begins the render pass for inline recording
+	VkCommandBuffer GetCommandBuffer();
+	// Only valid inside OnRender, records count draws into secondary command buffers on every core.
+	// record(commandBuffer, first, last) runs concurrently and must only touch its own range, a frame uses this or GetCommandBuffer but not both
+	void RecordParallel(uint32_t count, const CommandRecorder::RecordFunction& record);
 private:
 	bool m_Running = false;
 	SDL_Window* m_Window = nullptr;
@@ -24,12 +135,97 @@ private:
 	VkSurfaceKHR m_Surface = nullptr;
 	VkPhysicalDevice m_PhysicalDevice = nullptr;
 	VkDevice m_Device = nullptr;
+	PipelineCache m_PipelineCache;
+	PipelineBuilder m_PipelineBuilder;
+	ShaderLibrary m_ShaderLibrary;
+	LayoutCache m_LayoutCache;
+	BindlessHeap m_Bindless;
+	bool m_BindlessSupported = false;
+	AssetArchive m_Assets;
+	MemoryAllocator m_Allocator;
+	UploadEngine m_UploadEngine;
+	GpuProfiler m_GpuProfiler;
+	JobSystem m_Jobs;
+	CommandRecorder m_Recorder;
+	VkQueue m_GraphicsQueue = nullptr;
+	VkQueue m_PresentQueue = nullptr;
+	VkQueue m_TransferQueue = nullptr;
+	uint32_t m_GraphicsFamily = 0;
+	uint32_t m_TransferFamily = 0;
+	// Held around every submit to the graphics queue, uploads share it on devices without a transfer family
+	std::mutex m_QueueMutex;
+	VkSwapchainKHR m_Swapchain = nullptr;
+	// Set by window resizes, the swapchain is rebuilt after the next present
+	bool m_SwapchainDirty = false;
+	VkFormat m_TargetFormat = VK_FORMAT_UNDEFINED;
+	VkExtent2D m_TargetExtent{};
+	std::vector<VkImage> m_TargetImages;
+	std::vector<Allocation> m_TargetMemory;
+	std::vector<VkImageView> m_TargetViews;
+	std::vector<VkFramebuffer> m_Framebuffers;
+	VkRenderPass m_RenderPass = nullptr;
+	VkCommandPool m_CommandPool = nullptr;
+	std::vector<VkCommandBuffer> m_CommandBuffers;
+	uint32_t m_FramesInFlight = 0;
+	// Only acquire and present still need binary semaphores, everything else waits on timeline values
+	Timeline m_GraphicsTimeline;
+	// One per frame in flight
+	std::vector<VkSemaphore> m_ImageAvailableSemaphores;
+	std::vector<uint64_t> m_FrameValues;
+	// One per target image, presentation holds the semaphore until the image is acquired again
+	std::vector<VkSemaphore> m_RenderFinishedSemaphores;
+	// Timeline value of the frame that last rendered into each target image
+	std::vector<uint64_t> m_ImageValues;
+	std::vector<std::function<void()>> m_FrameReleases;
+	uint32_t m_CurrentFrame = 0;
+	uint32_t m_ImageIndex = 0;
+	uint64_t m_UploadWaitValue = 0;
+	uint32_t m_FrameScope = UINT32_MAX;
+	// The render pass is begun on first use in OnRender, since secondary command buffers need it begun differently
+	bool m_RenderPassBegun = false;
+	VkSubpassContents m_RenderPassContents = VK_SUBPASS_CONTENTS_INLINE;
+	uint32_t m_UpdateSnapshot = 0;
+	uint32_t m_RenderSnapshot = 0;
+	// Set while an update has produced a snapshot no frame has rendered yet
+	bool m_UpdateReady = false;
+	// When the input of the waiting snapshot was sampled
+	uint64_t m_UpdateInputSampled = 0;
+	JobCounter m_UpdateCounter;
+	uint64_t m_FrameCount = 0;
+	double m_DeltaTime = 0.0;
+	uint64_t m_GpuWaitTicks = 0;
+	// Graphics timeline value of each submitted frame and when its input was sampled
+	std::deque<std::pair<uint64_t, uint64_t>> m_PendingLatencies;
+	// Rolling windows of the latest samples, the totals cover the whole run
+	std::vector<double> m_Latencies;
+	size_t m_LatencyNext = 0;
+	double m_LatencyTotal = 0.0;
+	uint64_t m_LatencyCount = 0;
+	double m_InputLatency = 0.0;
+	std::vector<double> m_FrameTimes;
+	size_t m_FrameTimeNext = 0;
+	double m_FrameTimeTotal = 0.0;
+	double m_FrameTimeMax = 0.0;
+	FrameStats m_FrameStats;
 	void InitWindow();
 	void CreateInstance();
 	void SetupDebugMessenger();
 	void CreateSurface();
 	void SelectPhysicalDevice();
 	void CreateDevice();
+	void CreateSwapchain();
+	void CreateOffscreenTargets();
+	void CreateTargetViews();
+	void CreateRenderPass();
+	void CreateFramebuffers();
+	void CreateCommandObjects();
+	void CreateSyncObjects();
+	void CreateRenderFinishedSemaphores();
+	void RecreateSwapchain();
+	void MeasureLatency();
 	void InitVulkan();
+	void BeginFrame();
+	void BeginRenderPass(VkSubpassContents contents);
+	void EndFrame();
 	void CleanUp();
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <AssetFormat.h>
+#include <MappedFile.h>
+
+#include <string>
+#include <vector>
+
+// Many assets packed into one file behind a hashed index, so startup opens one file instead of one per asset.
+// The whole archive is mapped, an asset's pages are only read from disk the first time it is used. Read only, safe to use from any thread once open.
+class AssetArchive {
+public:
+	struct Asset {
+		const void* data = nullptr;
+		size_t size = 0;
+		uint64_t hash = 0;
+	};
+	// Returns false and leaves the archive closed if the file is missing or its index is malformed
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const;
+	uint32_t GetCount() const;
+	// Constant time, returns false when the archive is closed or has no asset by that name
+	bool Find(const char* name, Asset& asset) const;
+	// Packs files under their paths as given, with '\\' turned into '/'. Identical files share their data
+	static bool Write(const char* path, const std::vector<std::string>& files);
+private:
+	MappedFile m_File;
+	const AssetArchiveHeader* m_Header = nullptr;
+	const AssetArchiveBucket* m_Buckets = nullptr;
+	const AssetArchiveEntry* m_Entries = nullptr;
+};
\ No newline at end of file
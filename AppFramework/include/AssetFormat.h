@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// On disk layout of an asset archive, written at build time by AssetPacker and read through a mapping.
+// header | buckets[bucketCount] | entries[entryCount] | names | data
+// Everything is little endian, offsets are from the start of the file.
+
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = 0x4B415041; // "APAK"
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+// Every asset starts on this boundary, enough for SPIR-V words and SIMD loads
+constexpr uint64_t ASSET_ALIGNMENT = 16;
+
+struct AssetArchiveHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	// Power of two, at least twice entryCount so probe chains stay short
+	uint32_t bucketCount;
+	// Bytes taken by the header, buckets, entries and names, assets start at or after this
+	uint64_t indexSize;
+};
+
+struct AssetArchiveEntry {
+	uint64_t nameHash;
+	// AssetContentHash of the data, matches ShaderLibrary::Hash for SPIR-V
+	uint64_t contentHash;
+	uint64_t offset;
+	uint64_t size;
+	// The name is not null terminated
+	uint32_t nameOffset;
+	uint32_t nameLength;
+};
+
+// Open addressed with linear probing, each bucket holds an entry index plus one and 0 when empty
+using AssetArchiveBucket = uint32_t;
+
+// 64-bit FNV-1a over the bytes of a name, names use '/' separators on every platform
+inline uint64_t AssetNameHash(const char* name, size_t length) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ static_cast<uint8_t>(name[i])) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+// 64-bit FNV-1a over 32-bit words, a trailing partial word is folded in byte by byte. data must be 4 byte aligned
+inline uint64_t AssetContentHash(const void* data, size_t size) {
+	const uint32_t* words = static_cast<const uint32_t*>(data);
+	uint64_t hash = 14695981039346656037ULL;
+	size_t wordCount = size / sizeof(uint32_t);
+	for (size_t i = 0; i < wordCount; i++) {
+		hash = (hash ^ words[i]) * 1099511628211ULL;
+	}
+	const uint8_t* tail = reinterpret_cast<const uint8_t*>(words + wordCount);
+	for (size_t i = 0; i < size % sizeof(uint32_t); i++) {
+		hash = (hash ^ tail[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <Timeline.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// One large update-after-bind descriptor set holding every sampled image and storage buffer of the application.
+// Resources get a slot index once, shaders pick them by that index from a push constant, so a draw binds no descriptors of its own.
+// Shaders address the heap as set SET with runtime sized arrays at IMAGE_BINDING and BUFFER_BINDING. Safe to call from any thread.
+class BindlessHeap {
+public:
+	static constexpr uint32_t SET = 0;
+	static constexpr uint32_t IMAGE_BINDING = 0;
+	static constexpr uint32_t BUFFER_BINDING = 1;
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+	struct Stats {
+		uint32_t images = 0;
+		uint32_t buffers = 0;
+		uint32_t imageCapacity = 0;
+		uint32_t bufferCapacity = 0;
+		// Slots handed back and waiting for the frames that may still read them
+		uint32_t pendingReleases = 0;
+	};
+	// Whether the device has the descriptor indexing features the heap needs, and enables exactly those for device creation
+	static bool IsSupported(const VkPhysicalDeviceVulkan12Features& features);
+	static void EnableFeatures(VkPhysicalDeviceVulkan12Features& features);
+	// Capacities are clamped to the update-after-bind limits of the device. Released slots are reused once timeline passes the frame being recorded
+	bool Init(VkPhysicalDevice physicalDevice, VkDevice device, Timeline& timeline, uint32_t imageCapacity, uint32_t bufferCapacity);
+	void Shutdown();
+	bool IsReady() const;
+	// Writes the descriptor once and returns its slot, INVALID_INDEX when the heap is full
+	uint32_t AddImage(VkImageView view, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	uint32_t AddBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+	// The slot is reused after every frame recorded so far has completed, the resource itself has to live that long too
+	void ReleaseImage(uint32_t index);
+	void ReleaseBuffer(uint32_t index);
+	// Binds the heap at SET for pipelines whose layout came from the LayoutCache, once per command buffer
+	void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const;
+	VkDescriptorSetLayout GetSetLayout() const;
+	// The bindings of GetSetLayout, shader bindings in SET have to match one of these
+	const std::vector<VkDescriptorSetLayoutBinding>& GetBindings() const;
+	VkDescriptorSet GetSet() const;
+	Stats GetStats() const;
+private:
+	// Free-list index allocator, released slots are handed out again before the heap grows
+	struct Slots {
+		std::vector<uint32_t> free;
+		// Cleared on release, before the slot reaches the free list
+		std::vector<bool> used;
+		uint32_t next = 0;
+		uint32_t capacity = 0;
+		uint32_t live = 0;
+		uint32_t Allocate();
+	};
+	VkDevice m_Device = nullptr;
+	Timeline* m_Timeline = nullptr;
+	VkDescriptorPool m_Pool = nullptr;
+	VkDescriptorSetLayout m_Layout = nullptr;
+	VkDescriptorSet m_Set = nullptr;
+	std::vector<VkDescriptorSetLayoutBinding> m_Bindings;
+	mutable std::mutex m_Mutex;
+	Slots m_Images;
+	Slots m_Buffers;
+	uint32_t m_PendingReleases = 0;
+	void Release(Slots& slots, uint32_t index);
+};
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <JobSystem.h>
+
+#include <functional>
+#include <vector>
+
+// Records secondary command buffers over partitions of a draw list on the job system.
+// Every job thread owns one command pool per frame in flight, so pools are never shared and are reset whole once the frame retires.
+class CommandRecorder {
+public:
+	// Fills one secondary command buffer with the draws first to last, exclusive
+	using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last)>;
+	void Init(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, JobSystem& jobs);
+	void Shutdown();
+	// Call once the frame's previous submit has completed, resets that frame's pools
+	void BeginFrame(uint32_t frame);
+	// Call from the thread that initialised the job system. Records count draws in parallel and executes the results from primary,
+	// which must be inside a render pass begun for secondary command buffers.
+	void Record(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo& inheritance, uint32_t count, const RecordFunction& record);
+private:
+	struct ThreadPool {
+		VkCommandPool pool = nullptr;
+		std::vector<VkCommandBuffer> buffers;
+		size_t used = 0;
+	};
+	VkDevice m_Device = nullptr;
+	JobSystem* m_Jobs = nullptr;
+	uint32_t m_Frame = 0;
+	// Indexed by frame, then job thread
+	std::vector<std::vector<ThreadPool>> m_Pools;
+	std::vector<VkCommandBuffer> m_Recorded;
+	VkCommandBuffer RecordPartition(const VkCommandBufferInheritanceInfo& inheritance, uint32_t first, uint32_t last, const RecordFunction& record);
+};
\ No newline at end of file
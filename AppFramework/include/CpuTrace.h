@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Records where CPU time goes into per-thread ring buffers and exports it as Chrome trace-event JSON.
+// Recording takes no locks, only the first zone on a new thread registers its buffer.
+class CpuTrace {
+public:
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled() {
+		return s_Enabled.load(std::memory_order_relaxed);
+	}
+	static uint64_t Now() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+	// Shown as the track label in the trace viewer, the name is copied
+	static void SetThreadName(const char* name);
+	// name must be a string literal, only the pointer is stored
+	static void Record(const char* name, uint64_t startNs, uint64_t endNs);
+	// Load the file in chrome://tracing or ui.perfetto.dev
+	static bool WriteChromeTrace(const std::string& path);
+private:
+	static std::atomic<bool> s_Enabled;
+};
+
+class CpuZone {
+public:
+	explicit CpuZone(const char* name) : m_Name(name), m_Start(CpuTrace::IsEnabled() ? CpuTrace::Now() : 0) {}
+	~CpuZone() {
+		if (m_Start != 0) {
+			CpuTrace::Record(m_Name, m_Start, CpuTrace::Now());
+		}
+	}
+	CpuZone(const CpuZone&) = delete;
+	CpuZone& operator=(const CpuZone&) = delete;
+private:
+	const char* m_Name;
+	uint64_t m_Start;
+};
+
+#define CPU_TRACE_CONCAT_INNER(a, b) a##b
+#define CPU_TRACE_CONCAT(a, b) CPU_TRACE_CONCAT_INNER(a, b)
+#ifdef DISABLE_CPU_TRACE
+#define TRACE_ZONE(name)
+#else
+// Times the rest of the enclosing scope
+#define TRACE_ZONE(name) CpuZone CPU_TRACE_CONCAT(cpuZone, __LINE__)(name)
+#endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct GpuScopeStats {
+	std::string name;
+	double minMs = 0;
+	double avgMs = 0;
+	double p99Ms = 0;
+	size_t samples = 0;
+};
+
+// Times named scopes on the GPU with timestamp queries. Results are read back a full ring of frames later so the CPU never waits on them.
+class GpuProfiler {
+public:
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t maxScopes = 64);
+	void Shutdown();
+	// Call outside a render pass once the slot's previous frame has completed, collects that slot's previous results and resets its queries
+	void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+	uint32_t BeginScope(VkCommandBuffer commandBuffer, const char* name);
+	void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+	bool IsEnabled() const;
+	// Rolling statistics over the last SAMPLE_COUNT frames of every scope
+	std::vector<GpuScopeStats> GetStats() const;
+	void LogStats() const;
+	// Writes JSON when the path ends in .json, CSV otherwise
+	bool WriteReport(const std::string& path) const;
+
+	class Scope {
+	public:
+		Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name);
+		~Scope();
+	private:
+		GpuProfiler& m_Profiler;
+		VkCommandBuffer m_CommandBuffer;
+		uint32_t m_Scope;
+	};
+private:
+	static constexpr size_t SAMPLE_COUNT = 256;
+	struct Samples {
+		std::string name;
+		std::vector<double> values;
+		size_t next = 0;
+	};
+	struct Slot {
+		VkQueryPool pool = nullptr;
+		// Which named scope every query pair in this slot belongs to
+		std::vector<uint32_t> scopes;
+	};
+	VkDevice m_Device = nullptr;
+	double m_PeriodMs = 0;
+	uint64_t m_TimestampMask = 0;
+	uint32_t m_MaxScopes = 0;
+	std::vector<Slot> m_Slots;
+	uint32_t m_CurrentSlot = 0;
+	std::vector<Samples> m_Samples;
+	std::unordered_map<std::string, uint32_t> m_ScopeIndices;
+	void Collect(Slot& slot);
+};
\ No newline at end of file
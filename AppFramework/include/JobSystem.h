@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Counts unfinished jobs. Jobs queued with RunAfter start once the counter they depend on drops to zero.
+class JobCounter {
+public:
+	bool IsDone() const;
+private:
+	friend class JobSystem;
+	std::atomic<uint32_t> m_Pending{ 0 };
+	std::mutex m_Mutex;
+	std::vector<std::function<void()>> m_Continuations;
+};
+
+// A work-stealing thread pool. Every worker owns a deque it pushes and pops at the back, idle workers steal from the front of the others.
+// The thread that calls Init takes part as thread 0 whenever it waits, other threads only queue and block.
+class JobSystem {
+public:
+	using Job = std::function<void()>;
+	// A worker count of 0 starts one worker per hardware thread besides the calling one
+	void Init(uint32_t workerCount = 0);
+	// Finishes every queued job before joining the workers
+	void Shutdown();
+	void Run(Job job, JobCounter* counter = nullptr);
+	// Queues job once dependency is done, counter counts it as pending from now
+	void RunAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+	// Runs queued jobs until counter is done instead of blocking
+	void Wait(JobCounter& counter);
+	// Calls body(first, last) over [0, count) in chunks of at most grain and returns once all of them ran
+	void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t first, uint32_t last)>& body);
+	// Workers and the Init thread, the range of GetThreadIndex
+	uint32_t GetThreadCount() const;
+	// 0 for the Init thread, 1 to GetThreadCount() - 1 for workers, UINT32_MAX for any other thread
+	uint32_t GetThreadIndex() const;
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+	std::vector<std::unique_ptr<Queue>> m_Queues;
+	std::vector<std::thread> m_Workers;
+	std::atomic<uint32_t> m_Queued{ 0 };
+	std::atomic<uint32_t> m_Sleeping{ 0 };
+	std::atomic<bool> m_Stopping{ false };
+	std::mutex m_SleepMutex;
+	std::condition_variable m_Wake;
+	void Push(Job job);
+	bool TryRunOne(uint32_t thread);
+	void WorkerLoop(uint32_t thread);
+	void Finish(JobCounter* counter);
+};
\ No newline at end of file
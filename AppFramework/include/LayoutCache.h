@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <ShaderReflection.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Turns reflected shader interfaces into descriptor set and pipeline layouts, creating each distinct layout once.
+// Pipelines with the same interface share a layout handle, so descriptor sets stay compatible between them. Safe to call from any thread.
+class LayoutCache {
+public:
+	struct Stats {
+		uint32_t requests = 0;
+		uint32_t setLayouts = 0;
+		uint32_t pipelineLayouts = 0;
+	};
+	void Init(VkDevice device);
+	// Destroys every layout, pipelines built from them stay valid
+	void Shutdown();
+	// Serves set from the bindless heap layout when a shader declares runtime sized arrays in it, which then may only use heap bindings.
+	// Shaders without runtime sized arrays there keep their own layout for the set
+	void SetBindless(uint32_t set, VkDescriptorSetLayout layout, const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+	// The layout of one set of the reflection, nullptr if the set holds a runtime sized array outside the bindless set or creation failed
+	VkDescriptorSetLayout GetSetLayout(const ShaderReflection& reflection, uint32_t set);
+	// Merges the stages and returns the layout for the result, nullptr on a conflict between stages or a missing reflection.
+	// setLayouts receives one layout per set up to the highest used, unused sets below it get an empty layout
+	VkPipelineLayout GetPipelineLayout(const std::vector<const ShaderReflection*>& stages, std::vector<VkDescriptorSetLayout>* setLayouts = nullptr);
+	Stats GetStats() const;
+private:
+	VkDevice m_Device = nullptr;
+	mutable std::mutex m_Mutex;
+	// Keyed by the create info flattened into words, compared in full so a collision can never hand out the wrong layout
+	std::map<std::vector<uint32_t>, VkDescriptorSetLayout> m_SetLayouts;
+	std::map<std::vector<uint32_t>, VkPipelineLayout> m_PipelineLayouts;
+	Stats m_Stats;
+	uint32_t m_BindlessSet = UINT32_MAX;
+	VkDescriptorSetLayout m_BindlessLayout = nullptr;
+	std::vector<VkDescriptorSetLayoutBinding> m_BindlessBindings;
+	VkDescriptorSetLayout GetSetLayoutLocked(const ShaderReflection& reflection, uint32_t set);
+};
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+// A read only view of a whole file through the virtual memory system, no copy is made until pages are touched.
+// The data is page aligned, so it can be read as SPIR-V words directly.
+class MappedFile {
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+	// Returns false and leaves the file closed if it is missing, unreadable or empty
+	bool Open(const char* path);
+	void Close();
+	const void* GetData() const;
+	size_t GetSize() const;
+private:
+	const void* m_Data = nullptr;
+	size_t m_Size = 0;
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <TlsfBlock.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct Allocation {
+	VkDeviceMemory memory = nullptr;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	// Points at offset when the memory is host visible, blocks stay mapped for their whole lifetime
+	void* mapped = nullptr;
+	uint32_t memoryType = UINT32_MAX;
+	// UINT32_MAX for dedicated allocations
+	uint32_t block = UINT32_MAX;
+	TlsfAllocation range;
+};
+
+struct AllocatorStats {
+	uint32_t blockCount = 0;
+	uint32_t dedicatedCount = 0;
+	uint32_t allocationCount = 0;
+	VkDeviceSize bytesReserved = 0;
+	VkDeviceSize bytesUsed = 0;
+	VkDeviceSize largestFree = 0;
+	uint32_t freeRangeCount = 0;
+};
+
+// Sub-allocates buffers and images from a few large blocks per memory type instead of one vkAllocateMemory each
+class MemoryAllocator {
+public:
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = 64 * 1024 * 1024);
+	void Shutdown();
+	bool Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, Allocation& allocation);
+	void Free(Allocation& allocation);
+	// Creates, allocates and binds in one go, leaves the handle null on failure
+	bool CreateBuffer(const VkBufferCreateInfo& bufferInfo, VkMemoryPropertyFlags properties, VkBuffer& buffer, Allocation& allocation);
+	bool CreateImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, Allocation& allocation);
+	void DestroyBuffer(VkBuffer& buffer, Allocation& allocation);
+	void DestroyImage(VkImage& image, Allocation& allocation);
+	// Flushes or invalidates the allocation when its memory is not host coherent, expanded to nonCoherentAtomSize
+	void Flush(const Allocation& allocation) const;
+	void Invalidate(const Allocation& allocation) const;
+	AllocatorStats GetStats() const;
+	void LogStats() const;
+private:
+	struct Block {
+		VkDeviceMemory memory = nullptr;
+		uint32_t memoryType = 0;
+		void* mapped = nullptr;
+		TlsfBlock range;
+		Block(VkDeviceSize size, VkDeviceSize granularity) : range(size, granularity) {}
+	};
+	VkPhysicalDevice m_PhysicalDevice = nullptr;
+	VkDevice m_Device = nullptr;
+	VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+	VkDeviceSize m_BlockSize = 0;
+	VkDeviceSize m_Granularity = 1;
+	VkDeviceSize m_AtomSize = 1;
+	// Freed slots stay null so Allocation::block indices remain stable
+	std::vector<std::unique_ptr<Block>> m_Blocks;
+	uint32_t m_DedicatedCount = 0;
+	VkDeviceSize m_DedicatedBytes = 0;
+	mutable std::mutex m_Mutex;
+	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+	VkDeviceSize GetBlockSize(uint32_t memoryType) const;
+	bool AllocateMemory(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& memory, void*& mapped) const;
+	void FlushOrInvalidate(const Allocation& allocation, bool flush) const;
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Everything needed to build one graphics pipeline, viewport and scissor are always dynamic
+struct GraphicsPipelineDesc {
+	// Shared modules, from a ShaderLibrary, are used as is. Otherwise a module is made from the code and destroyed after the build
+	VkShaderModule vertexModule = nullptr;
+	VkShaderModule fragmentModule = nullptr;
+	std::vector<uint32_t> vertexCode;
+	std::vector<uint32_t> fragmentCode;
+	VkPipelineLayout layout = nullptr;
+	VkRenderPass renderPass = nullptr;
+	uint32_t subpass = 0;
+	std::vector<VkVertexInputBindingDescription> vertexBindings;
+	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+	bool blendEnable = false;
+};
+
+// Compiles pipelines on a pool of worker threads sharing one pipeline cache
+class PipelineBuilder {
+public:
+	// A worker count of 0 uses every hardware thread
+	void Init(VkDevice device, VkPipelineCache cache, uint32_t workerCount = 0);
+	// The future holds nullptr if the pipeline failed to build
+	std::future<VkPipeline> Build(GraphicsPipelineDesc desc);
+	// Finishes every queued build before joining the workers
+	void Shutdown();
+	uint32_t GetWorkerCount() const;
+private:
+	VkDevice m_Device = nullptr;
+	VkPipelineCache m_Cache = nullptr;
+	std::vector<std::thread> m_Workers;
+	std::deque<std::packaged_task<VkPipeline()>> m_Tasks;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping = false;
+	void WorkerLoop();
+	VkPipeline Compile(const GraphicsPipelineDesc& desc) const;
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+
+// A VkPipelineCache that is loaded from and written back to disk so pipelines compile once per device
+class PipelineCache {
+public:
+	// Falls back to an empty cache when the file is missing or was written by another device or driver
+	void Load(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path);
+	// Writes to a temporary file first and renames it over the old one so a crash never leaves a torn cache
+	void Save() const;
+	void Destroy();
+	VkPipelineCache GetHandle() const;
+	// Whether the cache was populated from disk
+	bool IsWarm() const;
+private:
+	VkDevice m_Device = nullptr;
+	VkPipelineCache m_Cache = nullptr;
+	std::string m_Path;
+	bool m_Warm = false;
+};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <AssetArchive.h>
+#include <ShaderReflection.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Creates each distinct piece of SPIR-V once and hands the same VkShaderModule to every pipeline using it.
+// Modules are keyed by a hash of their code, so identical shaders under different names are shared too. Safe to call from any thread.
+class ShaderLibrary {
+public:
+	struct Stats {
+		uint32_t loads = 0;
+		// Loads answered by an existing module
+		uint32_t hits = 0;
+		uint32_t modules = 0;
+	};
+	void Init(VkDevice device);
+	// Destroys every module, pipelines built from them stay valid
+	void Shutdown();
+	// Loads look in this archive before the file system, nullptr stops using one. The archive must stay open until Shutdown
+	void SetArchive(const AssetArchive* archive);
+	// Takes the shader from the archive when it holds path, otherwise maps the file rather than reading it. nullptr if it is missing or not SPIR-V
+	VkShaderModule Load(const char* path);
+	// code must be 4 byte aligned, size is in bytes
+	VkShaderModule Get(const void* code, size_t size);
+	// The interface of a module from this library, nullptr if its SPIR-V could not be reflected. Valid until Shutdown
+	const ShaderReflection* GetReflection(VkShaderModule module) const;
+	Stats GetStats() const;
+	// 64-bit FNV-1a over 32-bit words, SPIR-V is always a whole number of words
+	static uint64_t Hash(const void* code, size_t size);
+private:
+	VkDevice m_Device = nullptr;
+	mutable std::mutex m_Mutex;
+	struct Module {
+		// Compared on every hash match, so a collision can never hand out the wrong shader
+		std::vector<uint32_t> code;
+		VkShaderModule module = nullptr;
+	};
+	std::unordered_multimap<uint64_t, Module> m_Modules;
+	std::unordered_map<VkShaderModule, ShaderReflection> m_Reflections;
+	const AssetArchive* m_Archive = nullptr;
+	Stats m_Stats;
+	VkShaderModule Create(const void* code, size_t size, uint64_t hash);
+	VkShaderModule FindLocked(const void* code, size_t size, uint64_t hash) const;
+};
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+// The interface a shader declares, read straight from its SPIR-V: descriptor bindings, push constants and vertex inputs.
+// Stages are merged into one reflection per pipeline, which LayoutCache turns into shared layouts.
+struct ShaderReflection {
+	struct Binding {
+		uint32_t set = 0;
+		uint32_t binding = 0;
+		VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		// 0 for a runtime sized array
+		uint32_t count = 1;
+		VkShaderStageFlags stages = 0;
+	};
+	struct Input {
+		uint32_t location = 0;
+		// 32-bit components as declared, VK_FORMAT_UNDEFINED for types a vertex attribute cannot hold
+		VkFormat format = VK_FORMAT_UNDEFINED;
+	};
+	VkShaderStageFlags stages = 0;
+	// Sorted by set, then binding
+	std::vector<Binding> bindings;
+	// Vertex stage only, sorted by location, built-ins are left out
+	std::vector<Input> inputs;
+	// One range covering the push constant blocks of every stage, size is 0 when none declares one
+	VkPushConstantRange pushConstants{};
+	// Returns false for malformed or unsupported SPIR-V, code must be 4 byte aligned
+	bool Parse(const void* code, size_t size);
+	// Folds another stage in, returns false when both declare a binding with different types
+	bool Merge(const ShaderReflection& other);
+	// The inputs tightly packed into one interleaved binding in location order, for vertex data stored that way
+	void GetVertexInput(uint32_t binding, VkVertexInputBindingDescription& description, std::vector<VkVertexInputAttributeDescription>& attributes) const;
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// A timeline semaphore owned by one queue. Every submission to the queue signals the next value,
+// so waiting on the CPU is "wait until value X" and resources are recycled once their value has completed.
+class Timeline {
+public:
+	bool Init(VkDevice device, const char* name);
+	// Waits for everything signaled so far and runs every remaining completion callback
+	void Shutdown();
+	// Reserves the value the next submission signals, call under the same lock as that submit so values reach the queue in order
+	uint64_t Signal();
+	// Signals a value reserved by Signal from the CPU when its submission failed, so waits on it still return. Call under the submit lock
+	void SignalOnHost(uint64_t value);
+	// The value the next call to Signal will return
+	uint64_t GetPendingValue() const;
+	uint64_t GetLastSignaled() const;
+	uint64_t GetCompleted() const;
+	bool IsComplete(uint64_t value) const;
+	void Wait(uint64_t value) const;
+	// Runs callback from Collect once the GPU has reached value
+	void OnComplete(uint64_t value, std::function<void()> callback);
+	// Runs the callbacks of every completed value
+	void Collect();
+	VkSemaphore GetSemaphore() const;
+private:
+	VkDevice m_Device = nullptr;
+	VkSemaphore m_Semaphore = nullptr;
+	std::atomic<uint64_t> m_NextValue{ 1 };
+	// Last value seen by the GPU query, lets IsComplete skip the driver call for old values
+	mutable std::atomic<uint64_t> m_Completed{ 0 };
+	std::mutex m_Mutex;
+	std::deque<std::pair<uint64_t, std::function<void()>>> m_Callbacks;
+};
+
+// Gathers the waits and signals of one vkQueueSubmit, binary semaphores are passed with a value of 0.
+// Waiting on another queue's timeline is how work on different queues is ordered.
+class TimelineSubmit {
+public:
+	void Wait(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags stage);
+	void Signal(VkSemaphore semaphore, uint64_t value);
+	VkResult Submit(VkQueue queue, VkCommandBuffer commandBuffer) const;
+private:
+	std::vector<VkSemaphore> m_WaitSemaphores;
+	std::vector<uint64_t> m_WaitValues;
+	std::vector<VkPipelineStageFlags> m_WaitStages;
+	std::vector<VkSemaphore> m_SignalSemaphores;
+	std::vector<uint64_t> m_SignalValues;
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// What a sub-allocation holds, used to keep linear and optimal resources off the same bufferImageGranularity page
+enum class ResourceKind : uint8_t {
+	Linear, // Buffers and linear tiled images
+	Optimal // Optimal tiled images
+};
+
+struct TlsfAllocation {
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	uint32_t node = UINT32_MAX;
+};
+
+struct TlsfStats {
+	uint64_t size = 0;
+	uint64_t used = 0;
+	uint64_t largestFree = 0;
+	uint32_t allocationCount = 0;
+	uint32_t freeRangeCount = 0;
+};
+
+// Two level segregated fit allocator over a range of offsets, both allocation and free are O(1)
+class TlsfBlock {
+public:
+	TlsfBlock(uint64_t size, uint64_t granularity);
+	bool Allocate(uint64_t size, uint64_t alignment, ResourceKind kind, TlsfAllocation& allocation);
+	void Free(const TlsfAllocation& allocation);
+	bool IsEmpty() const;
+	uint64_t GetSize() const;
+	TlsfStats GetStats() const;
+private:
+	static constexpr uint32_t SL_COUNT_LOG2 = 5;
+	static constexpr uint32_t SL_COUNT = 1U << SL_COUNT_LOG2;
+	static constexpr uint32_t FL_SHIFT = SL_COUNT_LOG2 + 3;
+	static constexpr uint64_t SMALL_SIZE = 1ULL << FL_SHIFT;
+	static constexpr uint32_t FL_COUNT = 64 - FL_SHIFT + 1;
+	static constexpr uint32_t NIL = UINT32_MAX;
+	struct Node {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t prevPhysical = NIL;
+		uint32_t nextPhysical = NIL;
+		uint32_t prevFree = NIL;
+		uint32_t nextFree = NIL;
+		ResourceKind kind = ResourceKind::Linear;
+		bool free = true;
+	};
+	uint64_t m_Size;
+	uint64_t m_Granularity;
+	uint64_t m_Used = 0;
+	uint32_t m_AllocationCount = 0;
+	std::vector<Node> m_Nodes;
+	std::vector<uint32_t> m_UnusedNodes;
+	uint64_t m_FlBitmap = 0;
+	uint32_t m_SlBitmaps[FL_COUNT] = {};
+	uint32_t m_Heads[FL_COUNT][SL_COUNT];
+	uint32_t NewNode();
+	void ReleaseNode(uint32_t node);
+	void InsertFree(uint32_t node);
+	void RemoveFree(uint32_t node);
+	uint32_t FindFree(uint64_t size) const;
+	bool Conflicts(uint32_t node, ResourceKind kind) const;
+	static void Mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+};
\ No newline at end of file
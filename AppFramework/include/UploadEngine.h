@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <MemoryAllocator.h>
+#include <Timeline.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Streams buffer and image data to the GPU from any thread through a staging ring on the transfer queue.
+// Every call returns the timeline value that signals once the data has landed.
+class UploadEngine {
+public:
+	// queueMutex guards a transfer queue that is shared with the render thread, nullptr when the queue is dedicated
+	void Init(VkDevice device, MemoryAllocator& allocator, uint32_t transferFamily, VkQueue transferQueue, uint32_t graphicsFamily, std::mutex* queueMutex, VkDeviceSize ringSize = 32 * 1024 * 1024);
+	void Shutdown();
+	uint64_t UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+	// Uploads mip 0 of a color image and leaves it in finalLayout, returns 0 when it does not fit the ring
+	uint64_t UploadImage(VkImage image, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout);
+	// Submits everything recorded so far as one batch, a non-blocking flush gives up when a loader thread holds the engine
+	uint64_t Flush(bool blocking = true);
+	bool IsComplete(uint64_t value) const;
+	void Wait(uint64_t value) const;
+	// Render thread only: records the ownership acquires of finished batches and returns the value the submit has to wait on, 0 if none
+	uint64_t AcquireCompleted(VkCommandBuffer commandBuffer);
+	VkSemaphore GetSemaphore() const;
+private:
+	struct Batch {
+		VkCommandBuffer commandBuffer = nullptr;
+		uint64_t value = 0;
+		uint64_t ringEnd = 0;
+	};
+	struct Acquires {
+		uint64_t value = 0;
+		std::vector<VkBufferMemoryBarrier> buffers;
+		std::vector<VkImageMemoryBarrier> images;
+	};
+	VkDevice m_Device = nullptr;
+	MemoryAllocator* m_Allocator = nullptr;
+	VkQueue m_Queue = nullptr;
+	std::mutex* m_QueueMutex = nullptr;
+	uint32_t m_TransferFamily = 0;
+	uint32_t m_GraphicsFamily = 0;
+	VkCommandPool m_CommandPool = nullptr;
+	Timeline m_Timeline;
+	VkBuffer m_Staging = nullptr;
+	Allocation m_StagingMemory;
+	VkDeviceSize m_RingSize = 0;
+	// Monotonic byte positions, the ring offset is the position modulo the ring size
+	uint64_t m_Head = 0;
+	uint64_t m_Tail = 0;
+	Batch m_Recording;
+	std::vector<VkBufferMemoryBarrier> m_BufferReleases;
+	std::vector<VkImageMemoryBarrier> m_ImageReleases;
+	Acquires m_RecordingAcquires;
+	std::deque<Batch> m_InFlight;
+	std::vector<VkCommandBuffer> m_FreeCommandBuffers;
+	std::mutex m_Mutex;
+	// Separate so the render thread never waits behind a loader that is blocked on ring space
+	std::mutex m_AcquireMutex;
+	std::deque<Acquires> m_PendingAcquires;
+	bool NeedsOwnershipTransfer() const;
+	VkCommandBuffer BeginRecording();
+	bool ReserveStaging(VkDeviceSize size, VkDeviceSize& offset);
+	void Retire(bool wait);
+	uint64_t Submit();
+};
\ No newline at end of file
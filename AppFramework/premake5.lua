@@ -14,6 +14,9 @@ project "AppFramework"
 		includedirs { "$(VULKAN_SDK)/Include", "include" }
 		libdirs { "$(VULKAN_SDK)/Lib", "$(VULKAN_SDK)/Bin" }
 		links { "vulkan-1.lib", "SDL2.lib" }
+	filter "system:linux"
+		includedirs { "include" }
+		links { "vulkan", "SDL2", "pthread" }
 	filter "configurations:Debug"
 		defines "DEBUG"
 		symbols "On"
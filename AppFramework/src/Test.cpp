@@ -1,11 +1,34 @@
 #include <Application.h>
 
+#include <cstdlib>
+#include <cstring>
+
+struct TestOptions {
+	bool headless = false;
+	const char* profilePath = nullptr;
+	const char* tracePath = nullptr;
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	bool lowLatency = false;
+	double targetFps = 0.0;
+	bool pipelined = false;
+};
+
 class Test : public Application {
 public:
-	Test() {
+	Test(const TestOptions& options) {
 		Title = "Test";
 		Width = 800;
 		Height = 450;
+		Headless = options.headless;
+		GpuProfilePath = options.profilePath;
+		CpuTracePath = options.tracePath;
+		PresentMode = options.presentMode;
+		LowLatency = options.lowLatency;
+		TargetFps = options.targetFps;
+		PipelinedUpdate = options.pipelined;
+		if (options.headless) {
+			MaxFrames = 10000;
+		}
 	}
 
 	virtual void OnCreate() override {
@@ -15,10 +38,48 @@ public:
 	}
 
 	virtual void OnRender() override {
+		GpuProfiler::Scope scope(GetGpuProfiler(), GetCommandBuffer(), "Test");
 	}
 };
 
+static VkPresentModeKHR ParsePresentMode(const char* name) {
+	if (std::strcmp(name, "immediate") == 0) {
+		return VK_PRESENT_MODE_IMMEDIATE_KHR;
+	}
+	if (std::strcmp(name, "fifo") == 0) {
+		return VK_PRESENT_MODE_FIFO_KHR;
+	}
+	if (std::strcmp(name, "fifo-relaxed") == 0) {
+		return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	}
+	return VK_PRESENT_MODE_MAILBOX_KHR;
+}
+
 int main(int argc, char** argv) {
-	Test app;
+	TestOptions options;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--headless") == 0) {
+			options.headless = true;
+		}
+		else if (std::strcmp(argv[i], "--gpu-profile") == 0 && i + 1 < argc) {
+			options.profilePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--cpu-trace") == 0 && i + 1 < argc) {
+			options.tracePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc) {
+			options.presentMode = ParsePresentMode(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--low-latency") == 0) {
+			options.lowLatency = true;
+		}
+		else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+			options.targetFps = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--pipelined") == 0) {
+			options.pipelined = true;
+		}
+	}
+	Test app(options);
 	app.Run();
 }
\ No newline at end of file
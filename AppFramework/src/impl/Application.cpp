@@ -11,6 +11,9 @@
 #include <string>
 #include <map>
 #include <optional>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 std::vector<const char*> g_ValidationLayers = {
 	"VK_LAYER_KHRONOS_validation"
@@ -22,19 +25,46 @@ std::vector<const char*> g_ExtensionNames = {
 
 #pragma region Utilities
 
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+// Frame time and latency percentiles cover this many of the latest frames, so runs without MaxFrames stay bounded
+constexpr size_t STATS_WINDOW = 16384;
+
+// Overwrites the oldest sample once the window is full
+static void AddSample(std::vector<double>& samples, size_t& next, double value) {
+	if (samples.size() < STATS_WINDOW) {
+		samples.push_back(value);
+	}
+	else {
+		samples[next] = value;
+	}
+	next = (next + 1) % STATS_WINDOW;
+}
+
 struct QueueFamilies {
 	std::optional<uint32_t> graphics;
 	std::optional<uint32_t> present;
+	// Falls back to the graphics family when the device has no separate transfer queues
+	std::optional<uint32_t> transfer;
 	bool IsComplete() const {
 		return graphics.has_value() && present.has_value();
 	}
 };
 
+struct SwapchainSupport {
+	VkSurfaceCapabilitiesKHR capabilities{};
+	std::vector<VkSurfaceFormatKHR> formats;
+	std::vector<VkPresentModeKHR> presentModes;
+};
+
 static std::vector<const char*> GetGlobalExtensions(SDL_Window* window) {
-	uint32_t extensionCount;
-	SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, nullptr);
-	std::vector<const char*> extensions(extensionCount);
-	SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, extensions.data());
+	std::vector<const char*> extensions;
+	// Headless instances have no window so do not need any of the surface extensions
+	if (window != nullptr) {
+		uint32_t extensionCount;
+		SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, nullptr);
+		extensions.resize(extensionCount);
+		SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, extensions.data());
+	}
 #ifdef DEBUG
 	extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 #endif
@@ -100,12 +130,19 @@ static void PopulateDebugUtilsMessengerCreateInfoEXT(VkDebugUtilsMessengerCreate
 	messengerCreateInfo.pUserData = nullptr;
 }
 
-static bool CheckDeviceExtensionSupport(VkPhysicalDevice device) {
+// Without a surface nothing gets presented so the swapchain extension is not required
+static const std::vector<const char*>& GetDeviceExtensions(VkSurfaceKHR surface) {
+	static const std::vector<const char*> headlessExtensionNames;
+	return surface == nullptr ? headlessExtensionNames : g_ExtensionNames;
+}
+
+static bool CheckDeviceExtensionSupport(VkPhysicalDevice device, VkSurfaceKHR surface) {
 	uint32_t propertyCount;
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &propertyCount, nullptr);
 	std::vector<VkExtensionProperties> properties(propertyCount);
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &propertyCount, properties.data());
-	std::set<std::string> extSet(g_ExtensionNames.begin(), g_ExtensionNames.end());
+	const auto& extensionNames = GetDeviceExtensions(surface);
+	std::set<std::string> extSet(extensionNames.begin(), extensionNames.end());
 	for (const auto& property : properties) {
 		extSet.erase(property.extensionName);
 	}
@@ -120,24 +157,73 @@ static QueueFamilies FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR sur
 	QueueFamilies families;
 	uint32_t i = 0;
 	for (const auto& prop : familyProps) {
-		if (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+		// Transfer-only families are the copy engines, a compute family without graphics is the next best thing
+		if ((prop.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(prop.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+			if (!(prop.queueFlags & VK_QUEUE_COMPUTE_BIT) || !families.transfer.has_value()) {
+				families.transfer = i;
+			}
+		}
+		if (!families.IsComplete() && (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
 			families.graphics = i;
-			VkBool32 present;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+			VkBool32 present = VK_FALSE;
+			// Headless devices never present, the graphics family stands in so the queue setup stays the same
+			if (surface == nullptr) {
+				present = VK_TRUE;
+			}
+			else {
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+			}
 			if (present == VK_TRUE) {
 				families.present = i;
 			}
 		}
-		if (families.IsComplete()) {
-			break;
-		}
 		i++;
 	}
+	if (!families.transfer.has_value()) {
+		families.transfer = families.graphics;
+	}
 	return families;
 }
 
+static SwapchainSupport QuerySwapchainSupport(VkPhysicalDevice device, VkSurfaceKHR surface) {
+	SwapchainSupport support;
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &support.capabilities);
+	uint32_t formatCount;
+	vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
+	support.formats.resize(formatCount);
+	vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, support.formats.data());
+	uint32_t presentModeCount;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
+	support.presentModes.resize(presentModeCount);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, support.presentModes.data());
+	return support;
+}
+
+// Uploads signal their progress on a timeline semaphore, which is core from Vulkan 1.2
+static bool SupportsTimelineSemaphores(VkPhysicalDevice device) {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device, &properties);
+	if (properties.apiVersion < VK_API_VERSION_1_2) {
+		return false;
+	}
+	VkPhysicalDeviceVulkan12Features features12{};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &features12;
+	vkGetPhysicalDeviceFeatures2(device, &features);
+	return features12.timelineSemaphore == VK_TRUE;
+}
+
 static bool IsDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface) {
-	return CheckDeviceExtensionSupport(device) && FindQueueFamilies(device, surface).IsComplete();
+	if (!CheckDeviceExtensionSupport(device, surface) || !FindQueueFamilies(device, surface).IsComplete() || !SupportsTimelineSemaphores(device)) {
+		return false;
+	}
+	if (surface == nullptr) {
+		return true;
+	}
+	SwapchainSupport support = QuerySwapchainSupport(device, surface);
+	return !support.formats.empty() && !support.presentModes.empty();
 }
 
 static uint32_t RateDeviceSuitability(VkPhysicalDevice device, VkSurfaceKHR surface) {
@@ -158,11 +244,63 @@ static uint32_t RateDeviceSuitability(VkPhysicalDevice device, VkSurfaceKHR surf
 	return score;
 }
 
+static VkSurfaceFormatKHR ChooseSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats) {
+	for (const auto& format : formats) {
+		if (format.format == VK_FORMAT_B8G8R8A8_SRGB && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+			return format;
+		}
+	}
+	return formats.at(0);
+}
+
+static VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR>& presentModes, VkPresentModeKHR requested) {
+	for (const auto& presentMode : presentModes) {
+		if (presentMode == requested) {
+			return presentMode;
+		}
+	}
+	SDL_LogWarn(0, "Present mode %d is not supported, falling back to FIFO", static_cast<int>(requested));
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+// OS sleeps can overshoot by a scheduler tick, so the last stretch is spent yielding instead
+static void SleepUntil(Uint64 deadline) {
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 spin = frequency / 500;
+	for (Uint64 now = SDL_GetPerformanceCounter(); now < deadline; now = SDL_GetPerformanceCounter()) {
+		Uint64 remaining = deadline - now;
+		if (remaining > spin) {
+			std::this_thread::sleep_for(std::chrono::microseconds((remaining - spin) * 1000000 / frequency));
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+static VkExtent2D ChooseExtent(SDL_Window* window, const VkSurfaceCapabilitiesKHR& capabilities) {
+	if (capabilities.currentExtent.width != UINT32_MAX) {
+		return capabilities.currentExtent;
+	}
+	int width, height;
+	SDL_Vulkan_GetDrawableSize(window, &width, &height);
+	VkExtent2D extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+	extent.width = std::clamp(extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+	extent.height = std::clamp(extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+	return extent;
+}
+
 #pragma endregion
 
 void Application::InitWindow() {
+	if (Headless) {
+		// Only the timer is needed to drive the loop, no video driver has to be present
+		SDL_Init(SDL_INIT_TIMER);
+		m_Running = true;
+		return;
+	}
 	SDL_Init(SDL_INIT_VIDEO);
-	m_Window = SDL_CreateWindow(Title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, Width, Height, SDL_WINDOW_VULKAN);
+	m_Window = SDL_CreateWindow(Title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, Width, Height, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 	if (m_Window != nullptr) {
 		m_Running = true;
 		return;
@@ -172,8 +310,15 @@ void Application::InitWindow() {
 }
 
 void Application::CreateInstance() {
+	VkApplicationInfo appInfo{};
+	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	appInfo.pApplicationName = Title;
+	appInfo.pEngineName = "AppFramework";
+	appInfo.apiVersion = VK_API_VERSION_1_2;
+
 	VkInstanceCreateInfo instanceInfo{};
 	instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceInfo.pApplicationInfo = &appInfo;
 	
 	auto globalExtensions = GetGlobalExtensions(m_Window);
 
@@ -213,6 +358,9 @@ void Application::SetupDebugMessenger() {
 }
 
 void Application::CreateSurface() {
+	if (Headless) {
+		return;
+	}
 	if (SDL_Vulkan_CreateSurface(m_Window, m_Instance, &m_Surface) != SDL_TRUE) {
 		SDL_LogError(0, "Failed to create window surface!");
 #ifdef DEBUG
@@ -258,8 +406,9 @@ void Application::CreateDevice() {
 	VkDeviceCreateInfo deviceInfo{};
 	deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
-	deviceInfo.enabledExtensionCount = static_cast<uint32_t>(g_ExtensionNames.size());
-	deviceInfo.ppEnabledExtensionNames = g_ExtensionNames.data();
+	const auto& extensionNames = GetDeviceExtensions(m_Surface);
+	deviceInfo.enabledExtensionCount = static_cast<uint32_t>(extensionNames.size());
+	deviceInfo.ppEnabledExtensionNames = extensionNames.data();
 
 #ifdef DEBUG
 	deviceInfo.enabledLayerCount = static_cast<uint32_t>(g_ValidationLayers.size());
@@ -269,7 +418,7 @@ void Application::CreateDevice() {
 #endif
 
 	QueueFamilies families = FindQueueFamilies(m_PhysicalDevice, m_Surface);
-	std::set<uint32_t> queues = { families.graphics.value(), families.present.value() };
+	std::set<uint32_t> queues = { families.graphics.value(), families.present.value(), families.transfer.value() };
 	std::vector<VkDeviceQueueCreateInfo> queueInfos;
 	float priority = 1.0;
 	for (const auto& queue : queues) {
@@ -288,6 +437,26 @@ void Application::CreateDevice() {
 
 	deviceInfo.pEnabledFeatures = &deviceFeatures;
 
+	VkPhysicalDeviceVulkan12Features features12{};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.timelineSemaphore = VK_TRUE;
+	if (BindlessImages > 0 && BindlessBuffers > 0) {
+		VkPhysicalDeviceVulkan12Features supported12{};
+		supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		VkPhysicalDeviceFeatures2 supported{};
+		supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported.pNext = &supported12;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supported);
+		m_BindlessSupported = BindlessHeap::IsSupported(supported12);
+		if (m_BindlessSupported) {
+			BindlessHeap::EnableFeatures(features12);
+		}
+		else {
+			SDL_LogWarn(0, "Device lacks the descriptor indexing features of the bindless heap, it is disabled");
+		}
+	}
+	deviceInfo.pNext = &features12;
+
 	if (vkCreateDevice(m_PhysicalDevice, &deviceInfo, nullptr, &m_Device) != VK_SUCCESS) {
 		SDL_LogError(0, "Failed to create logical device!");
 #ifdef DEBUG
@@ -299,44 +468,746 @@ void Application::CreateDevice() {
 		SDL_Quit();
 		exit(EXIT_FAILURE);
 	}
+	vkGetDeviceQueue(m_Device, families.graphics.value(), 0, &m_GraphicsQueue);
+	vkGetDeviceQueue(m_Device, families.present.value(), 0, &m_PresentQueue);
+	vkGetDeviceQueue(m_Device, families.transfer.value(), 0, &m_TransferQueue);
+	m_GraphicsFamily = families.graphics.value();
+	m_TransferFamily = families.transfer.value();
+}
+
+void Application::CreateSwapchain() {
+	SwapchainSupport support = QuerySwapchainSupport(m_PhysicalDevice, m_Surface);
+	VkSurfaceFormatKHR surfaceFormat = ChooseSurfaceFormat(support.formats);
+	VkExtent2D extent = ChooseExtent(m_Window, support.capabilities);
+	uint32_t imageCount = support.capabilities.minImageCount + 1;
+	if (support.capabilities.maxImageCount > 0 && imageCount > support.capabilities.maxImageCount) {
+		imageCount = support.capabilities.maxImageCount;
+	}
+
+	VkSwapchainCreateInfoKHR swapchainInfo{};
+	swapchainInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	swapchainInfo.surface = m_Surface;
+	swapchainInfo.minImageCount = imageCount;
+	swapchainInfo.imageFormat = surfaceFormat.format;
+	swapchainInfo.imageColorSpace = surfaceFormat.colorSpace;
+	swapchainInfo.imageExtent = extent;
+	swapchainInfo.imageArrayLayers = 1;
+	swapchainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+	QueueFamilies families = FindQueueFamilies(m_PhysicalDevice, m_Surface);
+	uint32_t familyIndices[] = { families.graphics.value(), families.present.value() };
+	if (families.graphics != families.present) {
+		swapchainInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+		swapchainInfo.queueFamilyIndexCount = 2;
+		swapchainInfo.pQueueFamilyIndices = familyIndices;
+	}
+	else {
+		swapchainInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
+	swapchainInfo.preTransform = support.capabilities.currentTransform;
+	swapchainInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	swapchainInfo.presentMode = ChoosePresentMode(support.presentModes, PresentMode);
+	swapchainInfo.clipped = VK_TRUE;
+	// Handing over the old swapchain lets its queued presents finish while the new one is built
+	swapchainInfo.oldSwapchain = m_Swapchain;
+
+	if (vkCreateSwapchainKHR(m_Device, &swapchainInfo, nullptr, &m_Swapchain) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create swapchain!");
+		CleanUp();
+		exit(EXIT_FAILURE);
+	}
+	vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &imageCount, nullptr);
+	m_TargetImages.resize(imageCount);
+	vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &imageCount, m_TargetImages.data());
+	m_TargetFormat = surfaceFormat.format;
+	m_TargetExtent = extent;
+}
+
+void Application::CreateOffscreenTargets() {
+	m_TargetFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	m_TargetExtent = { Width, Height };
+	// One target per frame in flight, the frame's timeline value guards reuse of its target
+	m_TargetImages.resize(m_FramesInFlight);
+	m_TargetMemory.resize(m_FramesInFlight);
+	for (uint32_t i = 0; i < m_FramesInFlight; i++) {
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = m_TargetFormat;
+		imageInfo.extent = { m_TargetExtent.width, m_TargetExtent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (!m_Allocator.CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_TargetImages.at(i), m_TargetMemory.at(i))) {
+			SDL_LogError(0, "Failed to create offscreen target!");
+			CleanUp();
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+void Application::CreateTargetViews() {
+	m_TargetViews.resize(m_TargetImages.size());
+	for (size_t i = 0; i < m_TargetImages.size(); i++) {
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = m_TargetImages.at(i);
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = m_TargetFormat;
+		viewInfo.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+		if (vkCreateImageView(m_Device, &viewInfo, nullptr, &m_TargetViews.at(i)) != VK_SUCCESS) {
+			SDL_LogError(0, "Failed to create render target view!");
+			CleanUp();
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+void Application::CreateRenderPass() {
+	VkAttachmentDescription colorAttachment{};
+	colorAttachment.format = m_TargetFormat;
+	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	// Offscreen targets are left ready to be copied out since there is no presentation engine
+	colorAttachment.finalLayout = Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkAttachmentReference colorAttachmentRef{};
+	colorAttachmentRef.attachment = 0;
+	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorAttachmentRef;
+
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.srcAccessMask = 0;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = 1;
+	renderPassInfo.pAttachments = &colorAttachment;
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = 1;
+	renderPassInfo.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(m_Device, &renderPassInfo, nullptr, &m_RenderPass) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create render pass!");
+		CleanUp();
+		exit(EXIT_FAILURE);
+	}
+}
+
+void Application::CreateFramebuffers() {
+	m_Framebuffers.resize(m_TargetViews.size());
+	for (size_t i = 0; i < m_TargetViews.size(); i++) {
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_RenderPass;
+		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.pAttachments = &m_TargetViews.at(i);
+		framebufferInfo.width = m_TargetExtent.width;
+		framebufferInfo.height = m_TargetExtent.height;
+		framebufferInfo.layers = 1;
+		if (vkCreateFramebuffer(m_Device, &framebufferInfo, nullptr, &m_Framebuffers.at(i)) != VK_SUCCESS) {
+			SDL_LogError(0, "Failed to create framebuffer!");
+			CleanUp();
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+void Application::CreateCommandObjects() {
+	QueueFamilies families = FindQueueFamilies(m_PhysicalDevice, m_Surface);
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = families.graphics.value();
+	if (vkCreateCommandPool(m_Device, &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create command pool!");
+		CleanUp();
+		exit(EXIT_FAILURE);
+	}
+
+	m_CommandBuffers.resize(m_FramesInFlight);
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = m_CommandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = m_FramesInFlight;
+	if (vkAllocateCommandBuffers(m_Device, &allocInfo, m_CommandBuffers.data()) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to allocate command buffers!");
+		CleanUp();
+		exit(EXIT_FAILURE);
+	}
+}
+
+void Application::CreateSyncObjects() {
+	if (!m_GraphicsTimeline.Init(m_Device, "graphics")) {
+		CleanUp();
+		exit(EXIT_FAILURE);
+	}
+	m_FrameValues.assign(m_FramesInFlight, 0);
+	m_ImageValues.assign(m_TargetImages.size(), 0);
+	// Headless frames have nothing to acquire or present so the timeline is all they need
+	if (Headless) {
+		return;
+	}
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	m_ImageAvailableSemaphores.resize(m_FramesInFlight);
+	for (uint32_t i = 0; i < m_FramesInFlight; i++) {
+		if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores.at(i)) != VK_SUCCESS) {
+			SDL_LogError(0, "Failed to create semaphores!");
+			CleanUp();
+			exit(EXIT_FAILURE);
+		}
+	}
+	CreateRenderFinishedSemaphores();
+}
+
+void Application::CreateRenderFinishedSemaphores() {
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	m_RenderFinishedSemaphores.resize(m_TargetImages.size());
+	for (size_t i = 0; i < m_RenderFinishedSemaphores.size(); i++) {
+		if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_RenderFinishedSemaphores.at(i)) != VK_SUCCESS) {
+			SDL_LogError(0, "Failed to create semaphores!");
+			CleanUp();
+			exit(EXIT_FAILURE);
+		}
+	}
 }
 
 void Application::InitVulkan() {
+	m_FramesInFlight = std::clamp(FramesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
 	CreateInstance();
 	SetupDebugMessenger();
 	CreateSurface();
 	SelectPhysicalDevice();
 	CreateDevice();
+	m_PipelineCache.Load(m_PhysicalDevice, m_Device, PipelineCachePath);
+	m_PipelineBuilder.Init(m_Device, m_PipelineCache.GetHandle());
+	m_ShaderLibrary.Init(m_Device);
+	m_LayoutCache.Init(m_Device);
+	// Released slots wait on the graphics timeline, which only has to be initialized by the first release
+	if (m_BindlessSupported && m_Bindless.Init(m_PhysicalDevice, m_Device, m_GraphicsTimeline, BindlessImages, BindlessBuffers)) {
+		m_LayoutCache.SetBindless(BindlessHeap::SET, m_Bindless.GetSetLayout(), m_Bindless.GetBindings());
+	}
+	// Optional, without one every shader is loaded from its own file
+	if (AssetArchivePath != nullptr && AssetArchivePath[0] != '\0' && m_Assets.Open(AssetArchivePath)) {
+		m_ShaderLibrary.SetArchive(&m_Assets);
+	}
+	m_Allocator.Init(m_PhysicalDevice, m_Device);
+	// Without a dedicated family the uploads share the graphics queue, which then needs locking
+	std::mutex* queueMutex = m_TransferQueue == m_GraphicsQueue ? &m_QueueMutex : nullptr;
+	m_UploadEngine.Init(m_Device, m_Allocator, m_TransferFamily, m_TransferQueue, m_GraphicsFamily, queueMutex);
+	m_GpuProfiler.Init(m_PhysicalDevice, m_Device, m_GraphicsFamily, m_FramesInFlight);
+	if (Headless) {
+		CreateOffscreenTargets();
+	}
+	else {
+		CreateSwapchain();
+	}
+	CreateTargetViews();
+	CreateRenderPass();
+	CreateFramebuffers();
+	CreateCommandObjects();
+	CreateSyncObjects();
+	m_Recorder.Init(m_Device, m_GraphicsFamily, m_FramesInFlight, m_Jobs);
+}
+
+void Application::BeginFrame() {
+	// The slot is free once the frame submitted from it framesInFlight frames ago has completed
+	Uint64 waitStart = SDL_GetPerformanceCounter();
+	{
+		TRACE_ZONE("WaitForFrame");
+		m_GraphicsTimeline.Wait(m_FrameValues.at(m_CurrentFrame));
+	}
+
+	if (Headless) {
+		m_ImageIndex = m_CurrentFrame;
+	}
+	else {
+		TRACE_ZONE("Acquire");
+		VkResult result = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, m_ImageAvailableSemaphores.at(m_CurrentFrame), nullptr, &m_ImageIndex);
+		// Nothing was acquired from an out of date swapchain, so the semaphore is still unsignaled and can be reused right away
+		while (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			RecreateSwapchain();
+			result = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, m_ImageAvailableSemaphores.at(m_CurrentFrame), nullptr, &m_ImageIndex);
+		}
+	}
+	// Images can come back out of order, so the acquired one may still be rendered by another frame slot
+	if (!m_GraphicsTimeline.IsComplete(m_ImageValues.at(m_ImageIndex))) {
+		TRACE_ZONE("WaitForImage");
+		m_GraphicsTimeline.Wait(m_ImageValues.at(m_ImageIndex));
+	}
+	m_GpuWaitTicks += SDL_GetPerformanceCounter() - waitStart;
+	m_GraphicsTimeline.Collect();
+
+	VkCommandBuffer commandBuffer = m_CommandBuffers.at(m_CurrentFrame);
+	vkResetCommandBuffer(commandBuffer, 0);
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	// Uploads queued since the last frame go out now, the ones that already landed are handed to the graphics queue
+	m_UploadEngine.Flush(false);
+	m_UploadWaitValue = m_UploadEngine.AcquireCompleted(commandBuffer);
+	m_GpuProfiler.BeginFrame(commandBuffer, m_CurrentFrame);
+	m_FrameScope = m_GpuProfiler.BeginScope(commandBuffer, "Frame");
+	m_Recorder.BeginFrame(m_CurrentFrame);
+	m_RenderPassBegun = false;
+}
+
+void Application::BeginRenderPass(VkSubpassContents contents) {
+	VkCommandBuffer commandBuffer = m_CommandBuffers.at(m_CurrentFrame);
+	m_RenderPassBegun = true;
+	m_RenderPassContents = contents;
+	VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = m_RenderPass;
+	renderPassInfo.framebuffer = m_Framebuffers.at(m_ImageIndex);
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = m_TargetExtent;
+	renderPassInfo.clearValueCount = 1;
+	renderPassInfo.pClearValues = &clearColor;
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+}
+
+void Application::EndFrame() {
+	VkCommandBuffer commandBuffer = m_CommandBuffers.at(m_CurrentFrame);
+	// Still clears the target when OnRender recorded nothing
+	if (!m_RenderPassBegun) {
+		BeginRenderPass(VK_SUBPASS_CONTENTS_INLINE);
+	}
+	vkCmdEndRenderPass(commandBuffer);
+	m_GpuProfiler.EndScope(commandBuffer, m_FrameScope);
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to record command buffer!");
+		m_Running = false;
+		return;
+	}
+
+	// Acquire and present still go through binary semaphores, which take a value of 0 next to the timeline waits
+	TimelineSubmit submit;
+	if (!Headless) {
+		submit.Wait(m_ImageAvailableSemaphores.at(m_CurrentFrame), 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		submit.Signal(m_RenderFinishedSemaphores.at(m_ImageIndex), 0);
+	}
+	if (m_UploadWaitValue > 0) {
+		submit.Wait(m_UploadEngine.GetSemaphore(), m_UploadWaitValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	}
+	TRACE_ZONE("Submit");
+	std::unique_lock<std::mutex> queueLock(m_QueueMutex);
+	uint64_t value = m_GraphicsTimeline.Signal();
+	submit.Signal(m_GraphicsTimeline.GetSemaphore(), value);
+	if (submit.Submit(m_GraphicsQueue, commandBuffer) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to submit frame!");
+		m_GraphicsTimeline.SignalOnHost(value);
+		m_Running = false;
+		return;
+	}
+	m_FrameValues.at(m_CurrentFrame) = value;
+	m_ImageValues.at(m_ImageIndex) = value;
+	for (auto& release : m_FrameReleases) {
+		m_GraphicsTimeline.OnComplete(value, std::move(release));
+	}
+	m_FrameReleases.clear();
+
+	if (!Headless) {
+		TRACE_ZONE("Present");
+		VkPresentInfoKHR presentInfo{};
+		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		presentInfo.waitSemaphoreCount = 1;
+		presentInfo.pWaitSemaphores = &m_RenderFinishedSemaphores.at(m_ImageIndex);
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = &m_Swapchain;
+		presentInfo.pImageIndices = &m_ImageIndex;
+		VkResult result = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+		queueLock.unlock();
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_SwapchainDirty) {
+			RecreateSwapchain();
+		}
+	}
+	m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+}
+
+void Application::RecreateSwapchain() {
+	TRACE_ZONE("RecreateSwapchain");
+	m_SwapchainDirty = false;
+	VkSwapchainKHR oldSwapchain = m_Swapchain;
+	std::vector<VkImageView> oldViews = std::move(m_TargetViews);
+	std::vector<VkFramebuffer> oldFramebuffers = std::move(m_Framebuffers);
+	std::vector<VkSemaphore> oldSemaphores = std::move(m_RenderFinishedSemaphores);
+	CreateSwapchain();
+	CreateTargetViews();
+	CreateFramebuffers();
+	CreateRenderFinishedSemaphores();
+	m_ImageValues.assign(m_TargetImages.size(), 0);
+
+	// Instead of idling the device the old objects go once the frames that used them have retired.
+	// Presents can still be waiting on the old semaphores after rendering completes, hence the extra frames.
+	VkDevice device = m_Device;
+	m_GraphicsTimeline.OnComplete(m_GraphicsTimeline.GetLastSignaled() + m_FramesInFlight, [=]() {
+		for (auto framebuffer : oldFramebuffers) {
+			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		}
+		for (auto view : oldViews) {
+			vkDestroyImageView(device, view, nullptr);
+		}
+		for (auto semaphore : oldSemaphores) {
+			vkDestroySemaphore(device, semaphore, nullptr);
+		}
+		vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+	});
+	Width = m_TargetExtent.width;
+	Height = m_TargetExtent.height;
+	OnResize(Width, Height);
 }
 
 void Application::Run() {
-	InitWindow();
-	InitVulkan();
-	OnCreate();
-	float past = SDL_GetTicks() / 1000.0f;
+	CpuTrace::SetEnabled(CpuTracePath != nullptr);
+	CpuTrace::SetThreadName("Main");
+	Uint64 launch = SDL_GetPerformanceCounter();
+	{
+		TRACE_ZONE("Startup");
+		m_Jobs.Init();
+		InitWindow();
+		InitVulkan();
+		OnCreate();
+	}
+	double startupMs = static_cast<double>(SDL_GetPerformanceCounter() - launch) * 1000.0 / SDL_GetPerformanceFrequency();
+	SDL_Log("Startup took %.2fms with a %s pipeline cache", startupMs, m_PipelineCache.IsWarm() ? "warm" : "cold");
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 past = SDL_GetPerformanceCounter();
+	Uint64 start = past;
+	m_FrameTimes.clear();
+	m_FrameTimes.reserve(static_cast<size_t>(std::min<uint64_t>(MaxFrames, STATS_WINDOW)));
+	m_FrameTimeNext = 0;
+	m_FrameTimeTotal = 0;
+	m_FrameTimeMax = 0;
+	m_GpuWaitTicks = 0;
+	m_PendingLatencies.clear();
+	m_Latencies.clear();
+	m_LatencyNext = 0;
+	m_LatencyTotal = 0;
+	m_LatencyCount = 0;
+	Uint64 framePeriod = TargetFps > 0.0 ? static_cast<Uint64>(frequency / TargetFps) : 0;
+	Uint64 deadline = start;
 	while (m_Running) {
-		SDL_Event ev;
-		while (SDL_PollEvent(&ev)) {
-			switch (ev.type) {
-			case SDL_QUIT:
-				m_Running = false;
+		TRACE_ZONE("Frame");
+		// Sleeping before input is sampled keeps the limiter from adding to the latency
+		if (framePeriod > 0) {
+			TRACE_ZONE("FrameLimiter");
+			deadline = std::max(deadline + framePeriod, SDL_GetPerformanceCounter());
+			SleepUntil(deadline);
+		}
+		Uint64 frameStart = SDL_GetPerformanceCounter();
+		if (LowLatency) {
+			TRACE_ZONE("LatencyWait");
+			m_GraphicsTimeline.Wait(m_GraphicsTimeline.GetLastSignaled());
+			m_GpuWaitTicks += SDL_GetPerformanceCounter() - frameStart;
+		}
+		MeasureLatency();
+		{
+			TRACE_ZONE("PollEvents");
+			SDL_Event ev;
+			while (!Headless && SDL_PollEvent(&ev)) {
+				switch (ev.type) {
+				case SDL_QUIT:
+					m_Running = false;
+					break;
+				case SDL_WINDOWEVENT:
+					if (ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+						m_SwapchainDirty = true;
+					}
+					break;
+				}
 			}
 		}
-		float now = SDL_GetTicks() / 1000.0f;
-		float deltaTime = now - past;
+		// A minimized window has a zero sized surface that no swapchain can be built for
+		if (!Headless && (SDL_GetWindowFlags(m_Window) & SDL_WINDOW_MINIMIZED)) {
+			SDL_WaitEvent(nullptr);
+			continue;
+		}
+		// The performance counter keeps sub-millisecond frames from rounding to 0 or 1ms
+		Uint64 now = SDL_GetPerformanceCounter();
+		Uint64 inputSampled = now;
+		m_DeltaTime = static_cast<double>(now - past) / frequency;
 		past = now;
-		OnUpdate(deltaTime);
-		OnRender();
+		// Without a waiting snapshot, as on the first frame, the update runs in line to produce one
+		if (!m_UpdateReady) {
+			TRACE_ZONE("OnUpdate");
+			m_UpdateSnapshot = (m_UpdateSnapshot + 1) % SNAPSHOT_COUNT;
+			OnUpdate(static_cast<float>(m_DeltaTime));
+			m_UpdateInputSampled = inputSampled;
+		}
+		m_RenderSnapshot = m_UpdateSnapshot;
+		// The input this frame shows was sampled when its snapshot was updated, a frame earlier when pipelined
+		inputSampled = m_UpdateInputSampled;
+		m_UpdateReady = false;
+		if (PipelinedUpdate) {
+			// The next frame has not measured its delta yet, this one's is the best estimate
+			float dt = static_cast<float>(m_DeltaTime);
+			m_UpdateSnapshot = (m_UpdateSnapshot + 1) % SNAPSHOT_COUNT;
+			m_UpdateInputSampled = now;
+			m_Jobs.Run([this, dt]() {
+				TRACE_ZONE("OnUpdate");
+				OnUpdate(dt);
+			}, &m_UpdateCounter);
+			m_UpdateReady = true;
+		}
+		BeginFrame();
+		{
+			TRACE_ZONE("OnRender");
+			OnRender();
+		}
+		EndFrame();
+		if (PipelinedUpdate) {
+			// Hands the finished snapshot to the next frame, nothing touches application state across the loop boundary
+			TRACE_ZONE("UpdateWait");
+			m_Jobs.Wait(m_UpdateCounter);
+		}
+		m_PendingLatencies.push_back({ m_GraphicsTimeline.GetLastSignaled(), inputSampled });
+		Uint64 frameEnd = SDL_GetPerformanceCounter();
+		if (m_FrameTimes.empty()) {
+			m_FrameStats.startupMs = static_cast<double>(frameEnd - launch) * 1000.0 / frequency;
+		}
+		double frameMs = static_cast<double>(frameEnd - frameStart) * 1000.0 / frequency;
+		AddSample(m_FrameTimes, m_FrameTimeNext, frameMs);
+		m_FrameTimeTotal += frameMs;
+		m_FrameTimeMax = std::max(m_FrameTimeMax, frameMs);
+		m_FrameCount++;
+		if (MaxFrames != 0 && m_FrameCount >= MaxFrames) {
+			m_Running = false;
+		}
+	}
+	vkDeviceWaitIdle(m_Device);
+	MeasureLatency();
+	double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+	SDL_Log("Rendered %llu frames in %.3fs (%.1f fps) with %u frames in flight", static_cast<unsigned long long>(m_FrameCount), seconds, m_FrameCount / seconds, m_FramesInFlight);
+	m_FrameStats.frames = m_FrameCount;
+	m_FrameStats.seconds = seconds;
+	m_FrameStats.gpuWaitMs = m_FrameCount > 0 ? static_cast<double>(m_GpuWaitTicks) * 1000.0 / frequency / m_FrameCount : 0;
+	if (!m_FrameTimes.empty()) {
+		// Average and maximum cover the whole run, percentiles the window
+		std::vector<double> sorted = m_FrameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		m_FrameStats.cpuAvgMs = m_FrameTimeTotal / m_FrameCount;
+		m_FrameStats.cpuP50Ms = sorted.at((sorted.size() - 1) * 50 / 100);
+		m_FrameStats.cpuP95Ms = sorted.at((sorted.size() - 1) * 95 / 100);
+		m_FrameStats.cpuP99Ms = sorted.at((sorted.size() - 1) * 99 / 100);
+		m_FrameStats.cpuMaxMs = m_FrameTimeMax;
+	}
+	if (!m_Latencies.empty()) {
+		std::vector<double> sorted = m_Latencies;
+		std::sort(sorted.begin(), sorted.end());
+		m_FrameStats.latencyAvgMs = m_LatencyTotal / m_LatencyCount;
+		m_FrameStats.latencyP99Ms = sorted.at((sorted.size() - 1) * 99 / 100);
+		SDL_Log("Input to GPU completion latency avg %.2fms p99 %.2fms%s", m_FrameStats.latencyAvgMs, m_FrameStats.latencyP99Ms, LowLatency ? " in low latency mode" : "");
+	}
+	m_Allocator.LogStats();
+	m_GpuProfiler.LogStats();
+	if (GpuProfilePath != nullptr) {
+		m_GpuProfiler.WriteReport(GpuProfilePath);
 	}
+	if (CpuTracePath != nullptr) {
+		CpuTrace::WriteChromeTrace(CpuTracePath);
+	}
+	OnDestroy();
 	CleanUp();
 }
 
+Timeline& Application::GetGraphicsTimeline() {
+	return m_GraphicsTimeline;
+}
+
+JobSystem& Application::GetJobSystem() {
+	return m_Jobs;
+}
+
+uint32_t Application::GetUpdateSnapshot() const {
+	return m_UpdateSnapshot;
+}
+
+uint32_t Application::GetRenderSnapshot() const {
+	return m_RenderSnapshot;
+}
+
+void Application::ReleaseAfterFrame(std::function<void()> release) {
+	m_FrameReleases.push_back(std::move(release));
+}
+
+const FrameStats& Application::GetFrameStats() const {
+	return m_FrameStats;
+}
+
+void Application::Close() {
+	m_Running = false;
+}
+
+VkDevice Application::GetDevice() const {
+	return m_Device;
+}
+
+VkRenderPass Application::GetRenderPass() const {
+	return m_RenderPass;
+}
+
+VkExtent2D Application::GetExtent() const {
+	return m_TargetExtent;
+}
+
+VkPipelineCache Application::GetPipelineCache() const {
+	return m_PipelineCache.GetHandle();
+}
+
+PipelineBuilder& Application::GetPipelineBuilder() {
+	return m_PipelineBuilder;
+}
+
+ShaderLibrary& Application::GetShaderLibrary() {
+	return m_ShaderLibrary;
+}
+
+LayoutCache& Application::GetLayoutCache() {
+	return m_LayoutCache;
+}
+
+BindlessHeap& Application::GetBindless() {
+	return m_Bindless;
+}
+
+const AssetArchive& Application::GetAssets() const {
+	return m_Assets;
+}
+
+MemoryAllocator& Application::GetAllocator() {
+	return m_Allocator;
+}
+
+UploadEngine& Application::GetUploadEngine() {
+	return m_UploadEngine;
+}
+
+GpuProfiler& Application::GetGpuProfiler() {
+	return m_GpuProfiler;
+}
+
+double Application::GetDeltaTime() const {
+	return m_DeltaTime;
+}
+
+double Application::GetInputLatency() const {
+	return m_InputLatency;
+}
+
+// Completion is only seen when it is checked, so outside low latency mode this is an upper bound off by up to a frame
+void Application::MeasureLatency() {
+	uint64_t completed = m_GraphicsTimeline.GetCompleted();
+	Uint64 now = SDL_GetPerformanceCounter();
+	while (!m_PendingLatencies.empty() && m_PendingLatencies.front().first <= completed) {
+		m_InputLatency = static_cast<double>(now - m_PendingLatencies.front().second) * 1000.0 / SDL_GetPerformanceFrequency();
+		AddSample(m_Latencies, m_LatencyNext, m_InputLatency);
+		m_LatencyTotal += m_InputLatency;
+		m_LatencyCount++;
+		m_PendingLatencies.pop_front();
+	}
+}
+
+VkCommandBuffer Application::GetCommandBuffer() {
+	if (!m_RenderPassBegun) {
+		BeginRenderPass(VK_SUBPASS_CONTENTS_INLINE);
+	}
+	else if (m_RenderPassContents != VK_SUBPASS_CONTENTS_INLINE) {
+		SDL_LogError(0, "GetCommandBuffer used after RecordParallel in the same frame!");
+	}
+	return m_CommandBuffers.at(m_CurrentFrame);
+}
+
+void Application::RecordParallel(uint32_t count, const CommandRecorder::RecordFunction& record) {
+	if (!m_RenderPassBegun) {
+		BeginRenderPass(VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	}
+	else if (m_RenderPassContents != VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+		SDL_LogError(0, "RecordParallel used after GetCommandBuffer in the same frame!");
+		return;
+	}
+	VkCommandBufferInheritanceInfo inheritance{};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = m_RenderPass;
+	inheritance.subpass = 0;
+	inheritance.framebuffer = m_Framebuffers.at(m_ImageIndex);
+	m_Recorder.Record(m_CommandBuffers.at(m_CurrentFrame), inheritance, count, record);
+}
+
 void Application::CleanUp() {
+	// Runs the releases still queued behind the last frames before the objects they free go away
+	m_GraphicsTimeline.Shutdown();
+	m_Recorder.Shutdown();
+	m_Jobs.Shutdown();
+	for (auto semaphore : m_ImageAvailableSemaphores) {
+		vkDestroySemaphore(m_Device, semaphore, nullptr);
+	}
+	for (auto semaphore : m_RenderFinishedSemaphores) {
+		vkDestroySemaphore(m_Device, semaphore, nullptr);
+	}
+	vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
+	for (auto framebuffer : m_Framebuffers) {
+		vkDestroyFramebuffer(m_Device, framebuffer, nullptr);
+	}
+	vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
+	for (auto view : m_TargetViews) {
+		vkDestroyImageView(m_Device, view, nullptr);
+	}
+	// Swapchain images belong to the swapchain, only offscreen targets are owned here
+	if (Headless) {
+		for (size_t i = 0; i < m_TargetImages.size(); i++) {
+			m_Allocator.DestroyImage(m_TargetImages.at(i), m_TargetMemory.at(i));
+		}
+	}
+	else {
+		vkDestroySwapchainKHR(m_Device, m_Swapchain, nullptr);
+	}
+	m_UploadEngine.Shutdown();
+	m_Allocator.Shutdown();
+	m_GpuProfiler.Shutdown();
+	m_PipelineBuilder.Shutdown();
+	m_ShaderLibrary.Shutdown();
+	m_LayoutCache.Shutdown();
+	m_Bindless.Shutdown();
+	m_Assets.Close();
+	m_PipelineCache.Save();
+	m_PipelineCache.Destroy();
 	vkDestroyDevice(m_Device, nullptr);
 #ifdef DEBUG
 	DestroyDebugUtilsMessengerEXT(m_Instance, m_DebugMessenger, nullptr);
 #endif
-	vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+	if (!Headless) {
+		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+	}
 	vkDestroyInstance(m_Instance, nullptr);
 	SDL_DestroyWindow(m_Window);
 	SDL_Quit();
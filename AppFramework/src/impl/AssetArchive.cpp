@@ -0,0 +1,187 @@
+#include <AssetArchive.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool AssetArchive::Open(const char* path) {
+	Close();
+	if (!m_File.Open(path)) {
+		return false;
+	}
+	const uint8_t* base = static_cast<const uint8_t*>(m_File.GetData());
+	uint64_t fileSize = m_File.GetSize();
+	const AssetArchiveHeader* header = reinterpret_cast<const AssetArchiveHeader*>(base);
+	if (fileSize < sizeof(AssetArchiveHeader) || header->magic != ASSET_ARCHIVE_MAGIC || header->version != ASSET_ARCHIVE_VERSION ||
+		header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0 || header->bucketCount < header->entryCount ||
+		header->indexSize > fileSize ||
+		sizeof(AssetArchiveHeader) + header->bucketCount * sizeof(AssetArchiveBucket) + uint64_t(header->entryCount) * sizeof(AssetArchiveEntry) > header->indexSize) {
+		m_File.Close();
+		return false;
+	}
+	const AssetArchiveBucket* buckets = reinterpret_cast<const AssetArchiveBucket*>(base + sizeof(AssetArchiveHeader));
+	const AssetArchiveEntry* entries = reinterpret_cast<const AssetArchiveEntry*>(buckets + header->bucketCount);
+	// Checked once here so lookups can trust the index
+	for (uint32_t i = 0; i < header->bucketCount; i++) {
+		if (buckets[i] > header->entryCount) {
+			m_File.Close();
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < header->entryCount; i++) {
+		const AssetArchiveEntry& entry = entries[i];
+		if (uint64_t(entry.nameOffset) + entry.nameLength > header->indexSize || entry.offset % ASSET_ALIGNMENT != 0 ||
+			entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+			m_File.Close();
+			return false;
+		}
+	}
+	m_Header = header;
+	m_Buckets = buckets;
+	m_Entries = entries;
+	return true;
+}
+
+void AssetArchive::Close() {
+	m_File.Close();
+	m_Header = nullptr;
+	m_Buckets = nullptr;
+	m_Entries = nullptr;
+}
+
+bool AssetArchive::IsOpen() const {
+	return m_Header != nullptr;
+}
+
+uint32_t AssetArchive::GetCount() const {
+	return m_Header != nullptr ? m_Header->entryCount : 0;
+}
+
+bool AssetArchive::Find(const char* name, Asset& asset) const {
+	if (m_Header == nullptr) {
+		return false;
+	}
+	size_t length = strlen(name);
+	uint64_t hash = AssetNameHash(name, length);
+	const char* base = static_cast<const char*>(m_File.GetData());
+	uint32_t mask = m_Header->bucketCount - 1;
+	// The table is never full, so every probe ends at an empty bucket
+	for (uint32_t i = static_cast<uint32_t>(hash) & mask, probes = 0; m_Buckets[i] != 0 && probes < m_Header->bucketCount; i = (i + 1) & mask, probes++) {
+		const AssetArchiveEntry& entry = m_Entries[m_Buckets[i] - 1];
+		if (entry.nameHash == hash && entry.nameLength == length && memcmp(base + entry.nameOffset, name, length) == 0) {
+			asset.data = base + entry.offset;
+			asset.size = entry.size;
+			asset.hash = entry.contentHash;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AssetArchive::Write(const char* path, const std::vector<std::string>& files) {
+	struct Source {
+		std::string name;
+		std::vector<uint32_t> data;
+		size_t size = 0;
+		uint64_t hash = 0;
+		// Index of the first source with the same contents, or its own
+		size_t unique = 0;
+	};
+	std::vector<Source> sources(files.size());
+	std::unordered_multimap<uint64_t, size_t> byHash;
+	for (size_t i = 0; i < files.size(); i++) {
+		Source& source = sources[i];
+		source.name = files[i];
+		std::replace(source.name.begin(), source.name.end(), '\\', '/');
+		std::ifstream file(files[i], std::ios::ate | std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+		source.size = static_cast<size_t>(file.tellg());
+		// Read into words so the content hash sees the same alignment the mapped archive will have
+		source.data.resize((source.size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(source.data.data()), source.size);
+		source.hash = AssetContentHash(source.data.data(), source.size);
+		source.unique = i;
+		auto [first, last] = byHash.equal_range(source.hash);
+		for (auto it = first; it != last; ++it) {
+			const Source& other = sources[it->second];
+			if (other.size == source.size && memcmp(other.data.data(), source.data.data(), source.size) == 0) {
+				source.unique = it->second;
+				source.data.clear();
+				break;
+			}
+		}
+		if (source.unique == i) {
+			byHash.emplace(source.hash, i);
+		}
+	}
+
+	AssetArchiveHeader header{};
+	header.magic = ASSET_ARCHIVE_MAGIC;
+	header.version = ASSET_ARCHIVE_VERSION;
+	header.entryCount = static_cast<uint32_t>(sources.size());
+	header.bucketCount = 1;
+	while (header.bucketCount < header.entryCount * 2) {
+		header.bucketCount *= 2;
+	}
+	std::vector<AssetArchiveBucket> buckets(header.bucketCount, 0);
+	std::vector<AssetArchiveEntry> entries(sources.size());
+	uint64_t offset = sizeof(AssetArchiveHeader) + buckets.size() * sizeof(AssetArchiveBucket) + entries.size() * sizeof(AssetArchiveEntry);
+	std::string names;
+	for (size_t i = 0; i < sources.size(); i++) {
+		AssetArchiveEntry& entry = entries[i];
+		entry.nameHash = AssetNameHash(sources[i].name.data(), sources[i].name.size());
+		entry.contentHash = sources[i].hash;
+		entry.size = sources[i].size;
+		entry.nameOffset = static_cast<uint32_t>(offset + names.size());
+		entry.nameLength = static_cast<uint32_t>(sources[i].name.size());
+		names += sources[i].name;
+		uint32_t mask = header.bucketCount - 1;
+		uint32_t bucket = static_cast<uint32_t>(entry.nameHash) & mask;
+		while (buckets[bucket] != 0) {
+			if (entries[buckets[bucket] - 1].nameHash == entry.nameHash && sources[buckets[bucket] - 1].name == sources[i].name) {
+				return false;
+			}
+			bucket = (bucket + 1) & mask;
+		}
+		buckets[bucket] = static_cast<AssetArchiveBucket>(i + 1);
+	}
+	header.indexSize = offset + names.size();
+	// Assets go in the order given, so files used together at startup end up next to each other on disk
+	offset = AlignUp(header.indexSize, ASSET_ALIGNMENT);
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (sources[i].unique != i) {
+			entries[i].offset = entries[sources[i].unique].offset;
+			continue;
+		}
+		entries[i].offset = offset;
+		offset = AlignUp(offset + sources[i].size, ASSET_ALIGNMENT);
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(AssetArchiveBucket));
+	file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetArchiveEntry));
+	file.write(names.data(), names.size());
+	static const char padding[ASSET_ALIGNMENT] = {};
+	uint64_t written = header.indexSize;
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (sources[i].unique != i) {
+			continue;
+		}
+		file.write(padding, entries[i].offset - written);
+		file.write(reinterpret_cast<const char*>(sources[i].data.data()), sources[i].size);
+		written = entries[i].offset + sources[i].size;
+	}
+	return file.good();
+}
\ No newline at end of file
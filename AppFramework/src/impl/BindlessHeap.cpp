@@ -0,0 +1,234 @@
+#include <BindlessHeap.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+bool BindlessHeap::IsSupported(const VkPhysicalDeviceVulkan12Features& features) {
+	return features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound && features.descriptorBindingUpdateUnusedWhilePending &&
+		features.descriptorBindingSampledImageUpdateAfterBind && features.descriptorBindingStorageBufferUpdateAfterBind &&
+		features.shaderSampledImageArrayNonUniformIndexing;
+}
+
+void BindlessHeap::EnableFeatures(VkPhysicalDeviceVulkan12Features& features) {
+	features.runtimeDescriptorArray = VK_TRUE;
+	features.descriptorBindingPartiallyBound = VK_TRUE;
+	features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+}
+
+bool BindlessHeap::Init(VkPhysicalDevice physicalDevice, VkDevice device, Timeline& timeline, uint32_t imageCapacity, uint32_t bufferCapacity) {
+	m_Device = device;
+	m_Timeline = &timeline;
+
+	VkPhysicalDeviceVulkan12Properties properties12{};
+	properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &properties12;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+	// Combined image samplers count against both the sampler and the sampled image limits, and every stage sees the whole heap
+	imageCapacity = std::min({ imageCapacity, properties12.maxDescriptorSetUpdateAfterBindSampledImages, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		properties12.maxDescriptorSetUpdateAfterBindSamplers, properties12.maxPerStageDescriptorUpdateAfterBindSamplers });
+	bufferCapacity = std::min({ bufferCapacity, properties12.maxDescriptorSetUpdateAfterBindStorageBuffers, properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+	uint32_t resources = properties12.maxPerStageUpdateAfterBindResources;
+	if (imageCapacity + bufferCapacity > resources) {
+		imageCapacity = std::min(imageCapacity, resources / 2);
+		bufferCapacity = resources - imageCapacity;
+	}
+	if (imageCapacity == 0 || bufferCapacity == 0) {
+		SDL_LogError(0, "Device allows no update-after-bind descriptors, the bindless heap is disabled");
+		return false;
+	}
+
+	m_Bindings = {
+		{ IMAGE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageCapacity, VK_SHADER_STAGE_ALL, nullptr },
+		{ BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCapacity, VK_SHADER_STAGE_ALL, nullptr }
+	};
+	// Partially bound lets most slots stay empty, the other two let slots change while frames using other slots are in flight
+	VkDescriptorBindingFlags flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	VkDescriptorBindingFlags bindingFlags[] = { flags, flags };
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+	flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	flagsInfo.bindingCount = static_cast<uint32_t>(m_Bindings.size());
+	flagsInfo.pBindingFlags = bindingFlags;
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext = &flagsInfo;
+	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.bindingCount = static_cast<uint32_t>(m_Bindings.size());
+	layoutInfo.pBindings = m_Bindings.data();
+	if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_Layout) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create the bindless descriptor set layout!");
+		Shutdown();
+		return false;
+	}
+
+	VkDescriptorPoolSize poolSizes[] = {
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageCapacity },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCapacity }
+	};
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes = poolSizes;
+	if (vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_Pool) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create the bindless descriptor pool!");
+		Shutdown();
+		return false;
+	}
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_Pool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_Layout;
+	if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_Set) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to allocate the bindless descriptor set!");
+		Shutdown();
+		return false;
+	}
+	m_Images = Slots();
+	m_Images.capacity = imageCapacity;
+	m_Images.used.resize(imageCapacity);
+	m_Buffers = Slots();
+	m_Buffers.capacity = bufferCapacity;
+	m_Buffers.used.resize(bufferCapacity);
+	SDL_LogInfo(0, "Bindless heap holds %u images and %u buffers", imageCapacity, bufferCapacity);
+	return true;
+}
+
+void BindlessHeap::Shutdown() {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	// The set goes away with its pool
+	if (m_Pool != nullptr) {
+		vkDestroyDescriptorPool(m_Device, m_Pool, nullptr);
+	}
+	if (m_Layout != nullptr) {
+		vkDestroyDescriptorSetLayout(m_Device, m_Layout, nullptr);
+	}
+	m_Pool = nullptr;
+	m_Layout = nullptr;
+	m_Set = nullptr;
+	m_Bindings.clear();
+}
+
+bool BindlessHeap::IsReady() const {
+	return m_Set != nullptr;
+}
+
+uint32_t BindlessHeap::Slots::Allocate() {
+	uint32_t index;
+	if (!free.empty()) {
+		index = free.back();
+		free.pop_back();
+	}
+	else if (next < capacity) {
+		index = next++;
+	}
+	else {
+		return INVALID_INDEX;
+	}
+	used[index] = true;
+	live++;
+	return index;
+}
+
+uint32_t BindlessHeap::AddImage(VkImageView view, VkSampler sampler, VkImageLayout layout) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	uint32_t index = m_Images.Allocate();
+	if (index == INVALID_INDEX) {
+		SDL_LogError(0, "Bindless heap is out of image slots (%u)", m_Images.capacity);
+		return INVALID_INDEX;
+	}
+	VkDescriptorImageInfo imageInfo{ sampler, view, layout };
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = m_Set;
+	write.dstBinding = IMAGE_BINDING;
+	write.dstArrayElement = index;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &imageInfo;
+	// Writes to one set have to be serialized, so this stays under the lock
+	vkUpdateDescriptorSets(m_Device, 1, &write, 0, nullptr);
+	return index;
+}
+
+uint32_t BindlessHeap::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	uint32_t index = m_Buffers.Allocate();
+	if (index == INVALID_INDEX) {
+		SDL_LogError(0, "Bindless heap is out of buffer slots (%u)", m_Buffers.capacity);
+		return INVALID_INDEX;
+	}
+	VkDescriptorBufferInfo bufferInfo{ buffer, offset, range };
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = m_Set;
+	write.dstBinding = BUFFER_BINDING;
+	write.dstArrayElement = index;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo = &bufferInfo;
+	vkUpdateDescriptorSets(m_Device, 1, &write, 0, nullptr);
+	return index;
+}
+
+void BindlessHeap::ReleaseImage(uint32_t index) {
+	Release(m_Images, index);
+}
+
+void BindlessHeap::ReleaseBuffer(uint32_t index) {
+	Release(m_Buffers, index);
+}
+
+void BindlessHeap::Release(Slots& slots, uint32_t index) {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		// A second release would put the slot on the free list twice and hand it to two resources
+		if (index >= slots.next || !slots.used[index]) {
+			SDL_LogError(0, "Released bindless slot %u is not in use", index);
+			return;
+		}
+		slots.used[index] = false;
+		slots.live--;
+		m_PendingReleases++;
+	}
+	// The frame being recorded signals the pending value, every frame that may still read the old descriptor finishes at or before it
+	m_Timeline->OnComplete(m_Timeline->GetPendingValue(), [this, &slots, index]() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		slots.free.push_back(index);
+		m_PendingReleases--;
+	});
+}
+
+void BindlessHeap::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const {
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, SET, 1, &m_Set, 0, nullptr);
+}
+
+VkDescriptorSetLayout BindlessHeap::GetSetLayout() const {
+	return m_Layout;
+}
+
+const std::vector<VkDescriptorSetLayoutBinding>& BindlessHeap::GetBindings() const {
+	return m_Bindings;
+}
+
+VkDescriptorSet BindlessHeap::GetSet() const {
+	return m_Set;
+}
+
+BindlessHeap::Stats BindlessHeap::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Stats stats;
+	stats.images = m_Images.live;
+	stats.buffers = m_Buffers.live;
+	stats.imageCapacity = m_Images.capacity;
+	stats.bufferCapacity = m_Buffers.capacity;
+	stats.pendingReleases = m_PendingReleases;
+	return stats;
+}
\ No newline at end of file
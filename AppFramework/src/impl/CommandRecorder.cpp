@@ -0,0 +1,93 @@
+#include <CommandRecorder.h>
+#include <CpuTrace.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+// Below this many draws per partition handing work to another thread costs more than it saves
+constexpr uint32_t MIN_DRAWS_PER_PARTITION = 256;
+
+void CommandRecorder::Init(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, JobSystem& jobs) {
+	m_Device = device;
+	m_Jobs = &jobs;
+	m_Recorded.resize(m_Jobs->GetThreadCount());
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = queueFamily;
+	m_Pools.resize(framesInFlight);
+	for (auto& framePools : m_Pools) {
+		framePools.resize(m_Jobs->GetThreadCount());
+		for (auto& threadPool : framePools) {
+			if (vkCreateCommandPool(m_Device, &poolInfo, nullptr, &threadPool.pool) != VK_SUCCESS) {
+				SDL_LogError(0, "Failed to create recording command pool!");
+			}
+		}
+	}
+}
+
+void CommandRecorder::Shutdown() {
+	for (auto& framePools : m_Pools) {
+		for (auto& threadPool : framePools) {
+			vkDestroyCommandPool(m_Device, threadPool.pool, nullptr);
+		}
+	}
+	m_Pools.clear();
+}
+
+void CommandRecorder::BeginFrame(uint32_t frame) {
+	m_Frame = frame;
+	for (auto& threadPool : m_Pools.at(m_Frame)) {
+		if (threadPool.used > 0) {
+			vkResetCommandPool(m_Device, threadPool.pool, 0);
+			threadPool.used = 0;
+		}
+	}
+}
+
+void CommandRecorder::Record(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo& inheritance, uint32_t count, const RecordFunction& record) {
+	if (count == 0) {
+		return;
+	}
+	TRACE_ZONE("RecordParallel");
+	uint32_t partitions = std::min(m_Jobs->GetThreadCount(), (count + MIN_DRAWS_PER_PARTITION - 1) / MIN_DRAWS_PER_PARTITION);
+	m_Jobs->ParallelFor(partitions, 1, [&](uint32_t first, uint32_t last) {
+		for (uint32_t partition = first; partition < last; partition++) {
+			uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * partition / partitions);
+			uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (partition + 1) / partitions);
+			m_Recorded.at(partition) = RecordPartition(inheritance, begin, end, record);
+		}
+	});
+	// Executing in partition order keeps the draws in the order of the list
+	vkCmdExecuteCommands(primary, partitions, m_Recorded.data());
+}
+
+VkCommandBuffer CommandRecorder::RecordPartition(const VkCommandBufferInheritanceInfo& inheritance, uint32_t first, uint32_t last, const RecordFunction& record) {
+	TRACE_ZONE("RecordPartition");
+	// A thread that steals several partitions records each into its own buffer from the same pool
+	ThreadPool& threadPool = m_Pools.at(m_Frame).at(m_Jobs->GetThreadIndex());
+	if (threadPool.used == threadPool.buffers.size()) {
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = threadPool.pool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer = nullptr;
+		if (vkAllocateCommandBuffers(m_Device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+			SDL_LogError(0, "Failed to allocate secondary command buffer!");
+		}
+		threadPool.buffers.push_back(commandBuffer);
+	}
+	VkCommandBuffer commandBuffer = threadPool.buffers.at(threadPool.used++);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	record(commandBuffer, first, last);
+	vkEndCommandBuffer(commandBuffer);
+	return commandBuffer;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <CpuTrace.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+constexpr size_t EVENT_CAPACITY = 1 << 16;
+
+struct TraceEvent {
+	const char* name;
+	uint64_t start;
+	uint64_t end;
+};
+
+// Written only by its own thread, the exporter copies it out and drops whatever was overwritten meanwhile
+struct ThreadBuffer {
+	uint32_t id = 0;
+	// Guarded by the registry mutex, set once per thread so the lock costs nothing
+	std::string name;
+	std::atomic<uint64_t> written{ 0 };
+	std::vector<TraceEvent> events = std::vector<TraceEvent>(EVENT_CAPACITY);
+};
+
+std::atomic<bool> CpuTrace::s_Enabled{ false };
+
+static std::mutex g_RegistryMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> g_ThreadBuffers;
+
+// Buffers outlive their threads so zones from finished workers still make it into the export
+static ThreadBuffer& GetThreadBuffer() {
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(g_RegistryMutex);
+		g_ThreadBuffers.push_back(std::make_unique<ThreadBuffer>());
+		buffer = g_ThreadBuffers.back().get();
+		buffer->id = static_cast<uint32_t>(g_ThreadBuffers.size());
+	}
+	return *buffer;
+}
+
+static void WriteEscaped(std::ofstream& file, const char* text) {
+	for (const char* c = text; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') {
+			file << '\\';
+		}
+		file << *c;
+	}
+}
+
+void CpuTrace::SetEnabled(bool enabled) {
+	s_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void CpuTrace::SetThreadName(const char* name) {
+	ThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(g_RegistryMutex);
+	buffer.name = name;
+}
+
+void CpuTrace::Record(const char* name, uint64_t startNs, uint64_t endNs) {
+	ThreadBuffer& buffer = GetThreadBuffer();
+	uint64_t index = buffer.written.load(std::memory_order_relaxed);
+	buffer.events[index % EVENT_CAPACITY] = { name, startNs, endNs };
+	buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool CpuTrace::WriteChromeTrace(const std::string& path) {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		SDL_LogWarn(0, "Failed to write CPU trace to %s", path.c_str());
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(g_RegistryMutex);
+	// Timestamps are relative to the oldest event so the viewer starts at zero
+	uint64_t origin = UINT64_MAX;
+	std::vector<std::vector<TraceEvent>> snapshots;
+	for (const auto& buffer : g_ThreadBuffers) {
+		uint64_t end = buffer->written.load(std::memory_order_acquire);
+		uint64_t begin = end > EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+		std::vector<TraceEvent> events;
+		events.reserve(end - begin);
+		for (uint64_t i = begin; i < end; i++) {
+			events.push_back(buffer->events[i % EVENT_CAPACITY]);
+		}
+		// The owner may have kept recording while this copy was taken, the oldest entries could be torn
+		uint64_t after = buffer->written.load(std::memory_order_acquire);
+		size_t overwritten = after > begin + EVENT_CAPACITY ? static_cast<size_t>(after - begin - EVENT_CAPACITY) : 0;
+		events.erase(events.begin(), events.begin() + std::min(overwritten, events.size()));
+		for (const auto& event : events) {
+			origin = std::min(origin, event.start);
+		}
+		snapshots.push_back(std::move(events));
+	}
+
+	file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+	bool first = true;
+	size_t eventCount = 0;
+	for (size_t t = 0; t < g_ThreadBuffers.size(); t++) {
+		const ThreadBuffer& buffer = *g_ThreadBuffers[t];
+		if (!buffer.name.empty()) {
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer.id << ",\"args\":{\"name\":\"";
+			WriteEscaped(file, buffer.name.c_str());
+			file << "\"}}";
+			first = false;
+		}
+		for (const auto& event : snapshots[t]) {
+			file << (first ? "" : ",\n") << "{\"name\":\"";
+			WriteEscaped(file, event.name);
+			file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.id
+				<< ",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+			first = false;
+			eventCount++;
+		}
+	}
+	file << "\n]}\n";
+	SDL_Log("Wrote %zu CPU zones from %zu threads to %s", eventCount, g_ThreadBuffers.size(), path.c_str());
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include <GpuProfiler.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+void GpuProfiler::Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t maxScopes) {
+	m_Device = device;
+	m_MaxScopes = maxScopes;
+
+	uint32_t familyCount;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> familyProps(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, familyProps.data());
+	uint32_t validBits = familyProps.at(queueFamily).timestampValidBits;
+	if (validBits == 0) {
+		SDL_LogWarn(0, "Queue family %u does not support timestamps, GPU profiling is disabled", queueFamily);
+		return;
+	}
+	m_TimestampMask = validBits >= 64 ? UINT64_MAX : (1ULL << validBits) - 1;
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	m_PeriodMs = properties.limits.timestampPeriod / 1e6;
+
+	m_Slots.resize(framesInFlight);
+	for (auto& slot : m_Slots) {
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = m_MaxScopes * 2;
+		if (vkCreateQueryPool(m_Device, &poolInfo, nullptr, &slot.pool) != VK_SUCCESS) {
+			SDL_LogWarn(0, "Failed to create timestamp query pool, GPU profiling is disabled");
+			Shutdown();
+			return;
+		}
+		slot.scopes.reserve(m_MaxScopes);
+	}
+}
+
+void GpuProfiler::Shutdown() {
+	for (auto& slot : m_Slots) {
+		vkDestroyQueryPool(m_Device, slot.pool, nullptr);
+	}
+	m_Slots.clear();
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame) {
+	if (!IsEnabled()) {
+		return;
+	}
+	m_CurrentSlot = frame;
+	Slot& slot = m_Slots.at(frame);
+	Collect(slot);
+	vkCmdResetQueryPool(commandBuffer, slot.pool, 0, m_MaxScopes * 2);
+}
+
+uint32_t GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name) {
+	if (!IsEnabled()) {
+		return UINT32_MAX;
+	}
+	Slot& slot = m_Slots.at(m_CurrentSlot);
+	if (slot.scopes.size() >= m_MaxScopes) {
+		return UINT32_MAX;
+	}
+	auto found = m_ScopeIndices.find(name);
+	if (found == m_ScopeIndices.end()) {
+		found = m_ScopeIndices.emplace(name, static_cast<uint32_t>(m_Samples.size())).first;
+		Samples samples;
+		samples.name = name;
+		samples.values.reserve(SAMPLE_COUNT);
+		m_Samples.push_back(std::move(samples));
+	}
+	uint32_t scope = static_cast<uint32_t>(slot.scopes.size());
+	slot.scopes.push_back(found->second);
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.pool, scope * 2);
+	return scope;
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+	if (scope == UINT32_MAX) {
+		return;
+	}
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_Slots.at(m_CurrentSlot).pool, scope * 2 + 1);
+}
+
+bool GpuProfiler::IsEnabled() const {
+	return !m_Slots.empty();
+}
+
+std::vector<GpuScopeStats> GpuProfiler::GetStats() const {
+	std::vector<GpuScopeStats> stats;
+	for (const auto& samples : m_Samples) {
+		if (samples.values.empty()) {
+			continue;
+		}
+		std::vector<double> sorted = samples.values;
+		std::sort(sorted.begin(), sorted.end());
+		GpuScopeStats scopeStats;
+		scopeStats.name = samples.name;
+		scopeStats.samples = sorted.size();
+		scopeStats.minMs = sorted.front();
+		for (double value : sorted) {
+			scopeStats.avgMs += value;
+		}
+		scopeStats.avgMs /= sorted.size();
+		scopeStats.p99Ms = sorted.at((sorted.size() - 1) * 99 / 100);
+		stats.push_back(scopeStats);
+	}
+	return stats;
+}
+
+void GpuProfiler::LogStats() const {
+	for (const auto& scope : GetStats()) {
+		SDL_Log("GPU %s: min %.3fms, avg %.3fms, p99 %.3fms over %zu frames", scope.name.c_str(), scope.minMs, scope.avgMs, scope.p99Ms, scope.samples);
+	}
+}
+
+// Scope names come from callers, so quotes, backslashes and control characters must not end up raw in the JSON
+static std::string EscapeJson(const std::string& text) {
+	std::string escaped;
+	escaped.reserve(text.size());
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned int>(c));
+			escaped += code;
+		}
+		else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+bool GpuProfiler::WriteReport(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		SDL_LogWarn(0, "Failed to write GPU profile to %s", path.c_str());
+		return false;
+	}
+	auto stats = GetStats();
+	bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	if (json) {
+		file << "[\n";
+		for (size_t i = 0; i < stats.size(); i++) {
+			file << "\t{ \"name\": \"" << EscapeJson(stats[i].name) << "\", \"min_ms\": " << stats[i].minMs << ", \"avg_ms\": " << stats[i].avgMs
+				<< ", \"p99_ms\": " << stats[i].p99Ms << ", \"samples\": " << stats[i].samples << " }" << (i + 1 < stats.size() ? "," : "") << "\n";
+		}
+		file << "]\n";
+	}
+	else {
+		file << "name,min_ms,avg_ms,p99_ms,samples\n";
+		for (const auto& scope : stats) {
+			file << scope.name << "," << scope.minMs << "," << scope.avgMs << "," << scope.p99Ms << "," << scope.samples << "\n";
+		}
+	}
+	return true;
+}
+
+// The slot's previous frame has completed, so its queries are already written and reading them cannot stall
+void GpuProfiler::Collect(Slot& slot) {
+	if (slot.scopes.empty()) {
+		return;
+	}
+	uint32_t queryCount = static_cast<uint32_t>(slot.scopes.size() * 2);
+	std::vector<uint64_t> results(queryCount * 2);
+	vkGetQueryPoolResults(m_Device, slot.pool, 0, queryCount, results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t) * 2,
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	for (size_t i = 0; i < slot.scopes.size(); i++) {
+		// Each query is followed by its availability word
+		const uint64_t* begin = &results[i * 4];
+		const uint64_t* end = &results[i * 4 + 2];
+		if (begin[1] == 0 || end[1] == 0) {
+			continue;
+		}
+		double ms = static_cast<double>((end[0] - begin[0]) & m_TimestampMask) * m_PeriodMs;
+		Samples& samples = m_Samples.at(slot.scopes[i]);
+		if (samples.values.size() < SAMPLE_COUNT) {
+			samples.values.push_back(ms);
+		}
+		else {
+			samples.values[samples.next] = ms;
+		}
+		samples.next = (samples.next + 1) % SAMPLE_COUNT;
+	}
+	slot.scopes.clear();
+}
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+	: m_Profiler(profiler), m_CommandBuffer(commandBuffer), m_Scope(profiler.BeginScope(commandBuffer, name)) {}
+
+GpuProfiler::Scope::~Scope() {
+	m_Profiler.EndScope(m_CommandBuffer, m_Scope);
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <JobSystem.h>
+#include <CpuTrace.h>
+
+#include <algorithm>
+#include <string>
+
+static thread_local const JobSystem* t_System = nullptr;
+static thread_local uint32_t t_Thread = UINT32_MAX;
+
+bool JobCounter::IsDone() const {
+	return m_Pending == 0;
+}
+
+void JobSystem::Init(uint32_t workerCount) {
+	m_Stopping = false;
+	if (workerCount == 0) {
+		workerCount = std::max(1U, std::thread::hardware_concurrency()) - 1;
+	}
+	m_Queues.clear();
+	for (uint32_t i = 0; i <= workerCount; i++) {
+		m_Queues.push_back(std::make_unique<Queue>());
+	}
+	t_System = this;
+	t_Thread = 0;
+	for (uint32_t i = 1; i <= workerCount; i++) {
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+void JobSystem::Shutdown() {
+	if (m_Queues.empty()) {
+		return;
+	}
+	while (m_Queued > 0) {
+		if (!TryRunOne(0)) {
+			std::this_thread::yield();
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Stopping = true;
+	}
+	m_Wake.notify_all();
+	for (auto& worker : m_Workers) {
+		worker.join();
+	}
+	m_Workers.clear();
+	m_Queues.clear();
+	t_System = nullptr;
+	t_Thread = UINT32_MAX;
+}
+
+void JobSystem::Run(Job job, JobCounter* counter) {
+	if (counter != nullptr) {
+		counter->m_Pending++;
+	}
+	Push([this, job = std::move(job), counter]() {
+		job();
+		Finish(counter);
+	});
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, Job job, JobCounter* counter) {
+	if (counter != nullptr) {
+		counter->m_Pending++;
+	}
+	Job wrapped = [this, job = std::move(job), counter]() {
+		job();
+		Finish(counter);
+	};
+	{
+		// Finish takes the same lock after the count reaches zero, so the job is either seen there or pushed here
+		std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+		if (!dependency.IsDone()) {
+			dependency.m_Continuations.push_back(std::move(wrapped));
+			return;
+		}
+	}
+	Push(std::move(wrapped));
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	TRACE_ZONE("WaitForJobs");
+	uint32_t thread = GetThreadIndex();
+	while (!counter.IsDone()) {
+		if (thread == UINT32_MAX || !TryRunOne(thread)) {
+			std::this_thread::yield();
+		}
+	}
+	// The last Finish still holds the lock until it is done with the counter, which may live on the caller's stack
+	std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t first, uint32_t last)>& body) {
+	grain = std::max(1U, grain);
+	if (count <= grain || m_Queues.size() <= 1) {
+		body(0, count);
+		return;
+	}
+	JobCounter counter;
+	for (uint32_t first = 0; first < count; first += grain) {
+		uint32_t last = std::min(count, first + grain);
+		Run([&body, first, last]() {
+			body(first, last);
+		}, &counter);
+	}
+	Wait(counter);
+}
+
+uint32_t JobSystem::GetThreadCount() const {
+	return static_cast<uint32_t>(m_Queues.size());
+}
+
+uint32_t JobSystem::GetThreadIndex() const {
+	return t_System == this ? t_Thread : UINT32_MAX;
+}
+
+void JobSystem::Push(Job job) {
+	// Threads outside the pool hand their jobs to the Init thread's deque, which anyone can steal from
+	uint32_t thread = GetThreadIndex();
+	Queue& queue = *m_Queues.at(thread == UINT32_MAX ? 0 : thread);
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	m_Queued++;
+	if (m_Sleeping > 0) {
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Wake.notify_one();
+	}
+}
+
+bool JobSystem::TryRunOne(uint32_t thread) {
+	Job job;
+	{
+		// The newest job of the own deque is the one most likely to still be in cache
+		Queue& own = *m_Queues.at(thread);
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+		}
+	}
+	// Stealing takes the oldest job, which tends to be the biggest piece of the victim's work
+	for (size_t i = 1; !job && i < m_Queues.size(); i++) {
+		Queue& victim = *m_Queues.at((thread + i) % m_Queues.size());
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+		}
+	}
+	if (!job) {
+		return false;
+	}
+	m_Queued--;
+	job();
+	return true;
+}
+
+void JobSystem::WorkerLoop(uint32_t thread) {
+	t_System = this;
+	t_Thread = thread;
+	CpuTrace::SetThreadName(("Job " + std::to_string(thread)).c_str());
+	while (true) {
+		if (TryRunOne(thread)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping++;
+		m_Wake.wait(lock, [this]() { return m_Queued > 0 || m_Stopping; });
+		m_Sleeping--;
+		if (m_Stopping && m_Queued == 0) {
+			return;
+		}
+	}
+}
+
+void JobSystem::Finish(JobCounter* counter) {
+	if (counter == nullptr) {
+		return;
+	}
+	// Every decrement but the last skips the lock
+	uint32_t pending = counter->m_Pending;
+	while (pending > 1) {
+		if (counter->m_Pending.compare_exchange_weak(pending, pending - 1)) {
+			return;
+		}
+	}
+	std::vector<Job> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		if (--counter->m_Pending > 0) {
+			return;
+		}
+		continuations.swap(counter->m_Continuations);
+	}
+	for (auto& continuation : continuations) {
+		Push(std::move(continuation));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <LayoutCache.h>
+#include <CpuTrace.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+void LayoutCache::Init(VkDevice device) {
+	m_Device = device;
+}
+
+void LayoutCache::Shutdown() {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (auto& [key, layout] : m_PipelineLayouts) {
+		vkDestroyPipelineLayout(m_Device, layout, nullptr);
+	}
+	for (auto& [key, layout] : m_SetLayouts) {
+		vkDestroyDescriptorSetLayout(m_Device, layout, nullptr);
+	}
+	m_PipelineLayouts.clear();
+	m_SetLayouts.clear();
+	// Owned by the heap
+	m_BindlessLayout = nullptr;
+	m_BindlessBindings.clear();
+}
+
+void LayoutCache::SetBindless(uint32_t set, VkDescriptorSetLayout layout, const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_BindlessSet = set;
+	m_BindlessLayout = layout;
+	m_BindlessBindings = bindings;
+}
+
+VkDescriptorSetLayout LayoutCache::GetSetLayout(const ShaderReflection& reflection, uint32_t set) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return GetSetLayoutLocked(reflection, set);
+}
+
+VkPipelineLayout LayoutCache::GetPipelineLayout(const std::vector<const ShaderReflection*>& stages, std::vector<VkDescriptorSetLayout>* setLayouts) {
+	TRACE_ZONE("GetPipelineLayout");
+	ShaderReflection merged;
+	for (const ShaderReflection* stage : stages) {
+		if (stage == nullptr || !merged.Merge(*stage)) {
+			SDL_LogError(0, "Shader stages disagree on a descriptor binding or were not reflected");
+			return nullptr;
+		}
+	}
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.requests++;
+	uint32_t setCount = merged.bindings.empty() ? 0 : merged.bindings.back().set + 1;
+	std::vector<VkDescriptorSetLayout> layouts(setCount);
+	for (uint32_t set = 0; set < setCount; set++) {
+		layouts[set] = GetSetLayoutLocked(merged, set);
+		if (layouts[set] == nullptr) {
+			return nullptr;
+		}
+	}
+	if (setLayouts != nullptr) {
+		*setLayouts = layouts;
+	}
+	std::vector<uint32_t> key;
+	for (VkDescriptorSetLayout layout : layouts) {
+		uint64_t handle = reinterpret_cast<uint64_t>(layout);
+		key.push_back(static_cast<uint32_t>(handle));
+		key.push_back(static_cast<uint32_t>(handle >> 32));
+	}
+	const VkPushConstantRange& range = merged.pushConstants;
+	key.insert(key.end(), { range.stageFlags, range.offset, range.size });
+	auto found = m_PipelineLayouts.find(key);
+	if (found != m_PipelineLayouts.end()) {
+		return found->second;
+	}
+	VkPipelineLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = setCount;
+	layoutInfo.pSetLayouts = layouts.data();
+	layoutInfo.pushConstantRangeCount = range.size > 0 ? 1 : 0;
+	layoutInfo.pPushConstantRanges = &range;
+	VkPipelineLayout layout = nullptr;
+	if (vkCreatePipelineLayout(m_Device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create a pipeline layout!");
+		return nullptr;
+	}
+	m_PipelineLayouts.emplace(std::move(key), layout);
+	m_Stats.pipelineLayouts++;
+	return layout;
+}
+
+LayoutCache::Stats LayoutCache::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+VkDescriptorSetLayout LayoutCache::GetSetLayoutLocked(const ShaderReflection& reflection, uint32_t set) {
+	if (set == m_BindlessSet && m_BindlessLayout != nullptr) {
+		// Runtime sized arrays mean the shader indexes the heap, without any the set is an ordinary one
+		bool runtimeSized = false;
+		bool matches = true;
+		for (const ShaderReflection::Binding& binding : reflection.bindings) {
+			if (binding.set != set) {
+				continue;
+			}
+			runtimeSized |= binding.count == 0;
+			auto heap = std::find_if(m_BindlessBindings.begin(), m_BindlessBindings.end(), [&binding](const VkDescriptorSetLayoutBinding& candidate) {
+				return candidate.binding == binding.binding && candidate.descriptorType == binding.type && binding.count <= candidate.descriptorCount;
+			});
+			matches &= heap != m_BindlessBindings.end();
+		}
+		if (runtimeSized) {
+			if (!matches) {
+				SDL_LogError(0, "Set %u indexes the bindless heap but also has bindings the heap does not", set);
+				return nullptr;
+			}
+			return m_BindlessLayout;
+		}
+	}
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	std::vector<uint32_t> key;
+	for (const ShaderReflection::Binding& binding : reflection.bindings) {
+		if (binding.set != set) {
+			continue;
+		}
+		if (binding.count == 0) {
+			SDL_LogError(0, "Set %u binding %u is a runtime sized array, which is only supported in the bindless heap set", set, binding.binding);
+			return nullptr;
+		}
+		bindings.push_back({ binding.binding, binding.type, binding.count, binding.stages, nullptr });
+		key.insert(key.end(), { binding.binding, static_cast<uint32_t>(binding.type), binding.count, binding.stages });
+	}
+	auto found = m_SetLayouts.find(key);
+	if (found != m_SetLayouts.end()) {
+		return found->second;
+	}
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	VkDescriptorSetLayout layout = nullptr;
+	if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create a descriptor set layout!");
+		return nullptr;
+	}
+	m_SetLayouts.emplace(std::move(key), layout);
+	m_Stats.setLayouts++;
+	return layout;
+}
\ No newline at end of file
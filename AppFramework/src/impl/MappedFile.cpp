@@ -0,0 +1,94 @@
+#include <MappedFile.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const char* path) {
+	Close();
+	m_File = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE) {
+		m_File = nullptr;
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	m_Data = m_Mapping != nullptr ? MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (m_Data == nullptr) {
+		Close();
+		return false;
+	}
+	m_Size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_Data != nullptr) {
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping != nullptr) {
+		CloseHandle(m_Mapping);
+	}
+	if (m_File != nullptr) {
+		CloseHandle(m_File);
+	}
+	m_Data = nullptr;
+	m_Mapping = nullptr;
+	m_File = nullptr;
+	m_Size = 0;
+}
+#else
+bool MappedFile::Open(const char* path) {
+	Close();
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		close(file);
+		return false;
+	}
+	void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps its own reference to the file
+	close(file);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	m_Data = data;
+	m_Size = static_cast<size_t>(status.st_size);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_Data != nullptr) {
+		munmap(const_cast<void*>(m_Data), m_Size);
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+}
+#endif
+
+const void* MappedFile::GetData() const {
+	return m_Data;
+}
+
+size_t MappedFile::GetSize() const {
+	return m_Size;
+}
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include <MemoryAllocator.h>
+
+#include <SDL2/SDL.h>
+
+void MemoryAllocator::Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize) {
+	m_PhysicalDevice = physicalDevice;
+	m_Device = device;
+	m_BlockSize = blockSize;
+	vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &m_MemoryProperties);
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+	m_Granularity = properties.limits.bufferImageGranularity;
+	m_AtomSize = properties.limits.nonCoherentAtomSize;
+}
+
+void MemoryAllocator::Shutdown() {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (auto& block : m_Blocks) {
+		if (block == nullptr) {
+			continue;
+		}
+		if (!block->range.IsEmpty()) {
+			SDL_LogWarn(0, "Memory block of type %u freed with %u live allocations", block->memoryType, block->range.GetStats().allocationCount);
+		}
+		vkFreeMemory(m_Device, block->memory, nullptr);
+	}
+	m_Blocks.clear();
+	if (m_DedicatedCount > 0) {
+		SDL_LogWarn(0, "%u dedicated allocations were never freed", m_DedicatedCount);
+	}
+}
+
+bool MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, Allocation& allocation) {
+	uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+	if (memoryType == UINT32_MAX) {
+		SDL_LogError(0, "No memory type with properties 0x%x for this resource", properties);
+		return false;
+	}
+	allocation = Allocation{};
+	allocation.memoryType = memoryType;
+	allocation.size = requirements.size;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	VkDeviceSize blockSize = GetBlockSize(memoryType);
+	// Anything over half a block would waste most of one, so it gets memory of its own
+	if (requirements.size > blockSize / 2) {
+		if (!AllocateMemory(memoryType, requirements.size, allocation.memory, allocation.mapped)) {
+			return false;
+		}
+		m_DedicatedCount++;
+		m_DedicatedBytes += requirements.size;
+		return true;
+	}
+
+	uint32_t freeSlot = UINT32_MAX;
+	for (uint32_t i = 0; i < m_Blocks.size(); i++) {
+		Block* block = m_Blocks[i].get();
+		if (block == nullptr) {
+			freeSlot = i;
+			continue;
+		}
+		if (block->memoryType == memoryType && block->range.Allocate(requirements.size, requirements.alignment, kind, allocation.range)) {
+			allocation.block = i;
+			break;
+		}
+	}
+	if (allocation.block == UINT32_MAX) {
+		auto block = std::make_unique<Block>(blockSize, m_Granularity);
+		block->memoryType = memoryType;
+		if (!AllocateMemory(memoryType, blockSize, block->memory, block->mapped)) {
+			return false;
+		}
+		if (!block->range.Allocate(requirements.size, requirements.alignment, kind, allocation.range)) {
+			SDL_LogError(0, "Allocation of %llu bytes aligned to %llu does not fit a fresh block", (unsigned long long)requirements.size, (unsigned long long)requirements.alignment);
+			vkFreeMemory(m_Device, block->memory, nullptr);
+			return false;
+		}
+		if (freeSlot == UINT32_MAX) {
+			freeSlot = static_cast<uint32_t>(m_Blocks.size());
+			m_Blocks.emplace_back();
+		}
+		m_Blocks[freeSlot] = std::move(block);
+		allocation.block = freeSlot;
+	}
+
+	Block& block = *m_Blocks[allocation.block];
+	allocation.memory = block.memory;
+	allocation.offset = allocation.range.offset;
+	if (block.mapped != nullptr) {
+		allocation.mapped = static_cast<char*>(block.mapped) + allocation.offset;
+	}
+	return true;
+}
+
+void MemoryAllocator::Free(Allocation& allocation) {
+	if (allocation.memory == nullptr) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (allocation.block == UINT32_MAX) {
+		vkFreeMemory(m_Device, allocation.memory, nullptr);
+		m_DedicatedCount--;
+		m_DedicatedBytes -= allocation.size;
+		allocation = Allocation{};
+		return;
+	}
+
+	Block& block = *m_Blocks[allocation.block];
+	block.range.Free(allocation.range);
+	if (block.range.IsEmpty()) {
+		// Keep one empty block per memory type around so a single allocation bouncing at the edge does not thrash vkAllocateMemory
+		for (uint32_t i = 0; i < m_Blocks.size(); i++) {
+			Block* other = m_Blocks[i].get();
+			if (i != allocation.block && other != nullptr && other->memoryType == block.memoryType && other->range.IsEmpty()) {
+				vkFreeMemory(m_Device, block.memory, nullptr);
+				m_Blocks[allocation.block].reset();
+				break;
+			}
+		}
+	}
+	allocation = Allocation{};
+}
+
+bool MemoryAllocator::CreateBuffer(const VkBufferCreateInfo& bufferInfo, VkMemoryPropertyFlags properties, VkBuffer& buffer, Allocation& allocation) {
+	if (vkCreateBuffer(m_Device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create buffer");
+		buffer = nullptr;
+		return false;
+	}
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_Device, buffer, &requirements);
+	if (!Allocate(requirements, properties, ResourceKind::Linear, allocation)) {
+		vkDestroyBuffer(m_Device, buffer, nullptr);
+		buffer = nullptr;
+		return false;
+	}
+	vkBindBufferMemory(m_Device, buffer, allocation.memory, allocation.offset);
+	return true;
+}
+
+bool MemoryAllocator::CreateImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, Allocation& allocation) {
+	if (vkCreateImage(m_Device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create image");
+		image = nullptr;
+		return false;
+	}
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(m_Device, image, &requirements);
+	ResourceKind kind = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal : ResourceKind::Linear;
+	if (!Allocate(requirements, properties, kind, allocation)) {
+		vkDestroyImage(m_Device, image, nullptr);
+		image = nullptr;
+		return false;
+	}
+	vkBindImageMemory(m_Device, image, allocation.memory, allocation.offset);
+	return true;
+}
+
+void MemoryAllocator::DestroyBuffer(VkBuffer& buffer, Allocation& allocation) {
+	if (buffer != nullptr) {
+		vkDestroyBuffer(m_Device, buffer, nullptr);
+		buffer = nullptr;
+	}
+	Free(allocation);
+}
+
+void MemoryAllocator::DestroyImage(VkImage& image, Allocation& allocation) {
+	if (image != nullptr) {
+		vkDestroyImage(m_Device, image, nullptr);
+		image = nullptr;
+	}
+	Free(allocation);
+}
+
+void MemoryAllocator::Flush(const Allocation& allocation) const {
+	FlushOrInvalidate(allocation, true);
+}
+
+void MemoryAllocator::Invalidate(const Allocation& allocation) const {
+	FlushOrInvalidate(allocation, false);
+}
+
+AllocatorStats MemoryAllocator::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	AllocatorStats stats;
+	for (const auto& block : m_Blocks) {
+		if (block == nullptr) {
+			continue;
+		}
+		TlsfStats blockStats = block->range.GetStats();
+		stats.blockCount++;
+		stats.allocationCount += blockStats.allocationCount;
+		stats.bytesReserved += blockStats.size;
+		stats.bytesUsed += blockStats.used;
+		stats.freeRangeCount += blockStats.freeRangeCount;
+		if (blockStats.largestFree > stats.largestFree) {
+			stats.largestFree = blockStats.largestFree;
+		}
+	}
+	stats.dedicatedCount = m_DedicatedCount;
+	stats.allocationCount += m_DedicatedCount;
+	stats.bytesReserved += m_DedicatedBytes;
+	stats.bytesUsed += m_DedicatedBytes;
+	return stats;
+}
+
+void MemoryAllocator::LogStats() const {
+	AllocatorStats stats = GetStats();
+	SDL_Log("GPU memory: %u allocations in %u blocks and %u dedicated, %.2fMB used of %.2fMB reserved, %u free ranges, largest %.2fMB",
+		stats.allocationCount, stats.blockCount, stats.dedicatedCount,
+		stats.bytesUsed / (1024.0 * 1024.0), stats.bytesReserved / (1024.0 * 1024.0),
+		stats.freeRangeCount, stats.largestFree / (1024.0 * 1024.0));
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+	for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+	return UINT32_MAX;
+}
+
+// Small heaps such as the host visible window into VRAM get smaller blocks so one block cannot take most of the heap
+VkDeviceSize MemoryAllocator::GetBlockSize(uint32_t memoryType) const {
+	VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[memoryType].heapIndex].size;
+	return heapSize / 8 < m_BlockSize ? heapSize / 8 : m_BlockSize;
+}
+
+bool MemoryAllocator::AllocateMemory(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& memory, void*& mapped) const {
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+	if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to allocate %.2fMB of memory type %u", size / (1024.0 * 1024.0), memoryType);
+		memory = nullptr;
+		return false;
+	}
+	mapped = nullptr;
+	if (m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+	}
+	return true;
+}
+
+void MemoryAllocator::FlushOrInvalidate(const Allocation& allocation, bool flush) const {
+	if (allocation.mapped == nullptr || (m_MemoryProperties.memoryTypes[allocation.memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+		return;
+	}
+	VkMappedMemoryRange range{};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = allocation.memory;
+	range.offset = allocation.offset & ~(m_AtomSize - 1);
+	VkDeviceSize end = (allocation.offset + allocation.size + m_AtomSize - 1) & ~(m_AtomSize - 1);
+	range.size = allocation.block == UINT32_MAX ? VK_WHOLE_SIZE : end - range.offset;
+	if (flush) {
+		vkFlushMappedMemoryRanges(m_Device, 1, &range);
+	}
+	else {
+		vkInvalidateMappedMemoryRanges(m_Device, 1, &range);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include <PipelineBuilder.h>
+#include <CpuTrace.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+static VkShaderModule CreateShaderModule(VkDevice device, const std::vector<uint32_t>& code) {
+	VkShaderModuleCreateInfo moduleInfo{};
+	moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize = code.size() * sizeof(uint32_t);
+	moduleInfo.pCode = code.data();
+	VkShaderModule module = nullptr;
+	if (vkCreateShaderModule(device, &moduleInfo, nullptr, &module) != VK_SUCCESS) {
+		return nullptr;
+	}
+	return module;
+}
+
+void PipelineBuilder::Init(VkDevice device, VkPipelineCache cache, uint32_t workerCount) {
+	m_Device = device;
+	m_Cache = cache;
+	m_Stopping = false;
+	if (workerCount == 0) {
+		workerCount = std::max(1U, std::thread::hardware_concurrency());
+	}
+	for (uint32_t i = 0; i < workerCount; i++) {
+		m_Workers.emplace_back(&PipelineBuilder::WorkerLoop, this);
+	}
+}
+
+std::future<VkPipeline> PipelineBuilder::Build(GraphicsPipelineDesc desc) {
+	std::packaged_task<VkPipeline()> task([this, desc = std::move(desc)]() {
+		return Compile(desc);
+	});
+	std::future<VkPipeline> result = task.get_future();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Tasks.push_back(std::move(task));
+	}
+	m_Condition.notify_one();
+	return result;
+}
+
+void PipelineBuilder::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+	for (auto& worker : m_Workers) {
+		worker.join();
+	}
+	m_Workers.clear();
+}
+
+uint32_t PipelineBuilder::GetWorkerCount() const {
+	return static_cast<uint32_t>(m_Workers.size());
+}
+
+void PipelineBuilder::WorkerLoop() {
+	CpuTrace::SetThreadName("PipelineBuilder");
+	while (true) {
+		std::packaged_task<VkPipeline()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Tasks.empty()) {
+				return;
+			}
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+		}
+		task();
+	}
+}
+
+// Pipeline creation only reads the device and the internally synchronized cache, so any number of these can run at once
+VkPipeline PipelineBuilder::Compile(const GraphicsPipelineDesc& desc) const {
+	TRACE_ZONE("CompilePipeline");
+	// Only modules made here are owned here
+	VkShaderModule ownedVert = desc.vertexModule == nullptr ? CreateShaderModule(m_Device, desc.vertexCode) : nullptr;
+	VkShaderModule ownedFrag = desc.fragmentModule == nullptr ? CreateShaderModule(m_Device, desc.fragmentCode) : nullptr;
+	VkShaderModule vertModule = desc.vertexModule != nullptr ? desc.vertexModule : ownedVert;
+	VkShaderModule fragModule = desc.fragmentModule != nullptr ? desc.fragmentModule : ownedFrag;
+	if (vertModule == nullptr || fragModule == nullptr) {
+		SDL_LogError(0, "Failed to create shader modules!");
+		vkDestroyShaderModule(m_Device, ownedVert, nullptr);
+		vkDestroyShaderModule(m_Device, ownedFrag, nullptr);
+		return nullptr;
+	}
+
+	VkPipelineShaderStageCreateInfo stages[2]{};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = vertModule;
+	stages[0].pName = "main";
+	stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = fragModule;
+	stages[1].pName = "main";
+
+	VkPipelineVertexInputStateCreateInfo vertexInput{};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+	vertexInput.pVertexBindingDescriptions = desc.vertexBindings.data();
+	vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+	vertexInput.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = desc.topology;
+	inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	VkPipelineViewportStateCreateInfo viewportState{};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState{};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VkPipelineRasterizationStateCreateInfo rasterization{};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.depthClampEnable = VK_FALSE;
+	rasterization.rasterizerDiscardEnable = VK_FALSE;
+	rasterization.polygonMode = desc.polygonMode;
+	rasterization.lineWidth = 1.0f;
+	rasterization.cullMode = desc.cullMode;
+	rasterization.frontFace = desc.frontFace;
+	rasterization.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo multisample{};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisample.sampleShadingEnable = VK_FALSE;
+	multisample.minSampleShading = 1.0f;
+
+	VkPipelineColorBlendAttachmentState blendAttachment{};
+	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	blendAttachment.blendEnable = desc.blendEnable ? VK_TRUE : VK_FALSE;
+	blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+	blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend{};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.logicOpEnable = VK_FALSE;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blendAttachment;
+
+	VkGraphicsPipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 2;
+	pipelineInfo.pStages = stages;
+	pipelineInfo.pVertexInputState = &vertexInput;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterization;
+	pipelineInfo.pMultisampleState = &multisample;
+	pipelineInfo.pColorBlendState = &colorBlend;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = desc.layout;
+	pipelineInfo.renderPass = desc.renderPass;
+	pipelineInfo.subpass = desc.subpass;
+	pipelineInfo.basePipelineHandle = nullptr;
+	pipelineInfo.basePipelineIndex = -1;
+
+	VkPipeline pipeline = nullptr;
+	if (vkCreateGraphicsPipelines(m_Device, m_Cache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create graphics pipeline!");
+		pipeline = nullptr;
+	}
+	vkDestroyShaderModule(m_Device, ownedVert, nullptr);
+	vkDestroyShaderModule(m_Device, ownedFrag, nullptr);
+	return pipeline;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <PipelineCache.h>
+
+#include <SDL2/SDL.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+static std::vector<char> ReadCacheFile(const std::string& path) {
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		return {};
+	}
+	// tellg reports -1 when it fails, which must not become a huge allocation
+	std::streamoff size = file.tellg();
+	if (size <= 0) {
+		return {};
+	}
+	std::vector<char> data(static_cast<size_t>(size));
+	file.seekg(0);
+	if (!file.read(data.data(), data.size())) {
+		SDL_LogWarn(0, "Failed to read pipeline cache %s", path.c_str());
+		return {};
+	}
+	return data;
+}
+
+// The driver rejects foreign data on its own, but checking the header first gives a clear reason and never risks a bad driver
+static bool IsCacheCompatible(VkPhysicalDevice physicalDevice, const std::vector<char>& data) {
+	if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+		return false;
+	}
+	VkPipelineCacheHeaderVersionOne header;
+	std::memcpy(&header, data.data(), sizeof(header));
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	return header.headerSize >= sizeof(header) && header.headerSize <= data.size() &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.vendorID == properties.vendorID &&
+		header.deviceID == properties.deviceID &&
+		std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::Load(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path) {
+	m_Device = device;
+	m_Path = path;
+	std::vector<char> data = ReadCacheFile(path);
+	m_Warm = IsCacheCompatible(physicalDevice, data);
+	if (!data.empty() && !m_Warm) {
+		SDL_LogWarn(0, "Ignoring pipeline cache %s, it was written for another device or driver", path.c_str());
+	}
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = m_Warm ? data.size() : 0;
+	cacheInfo.pInitialData = m_Warm ? data.data() : nullptr;
+	if (vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_Cache) != VK_SUCCESS) {
+		SDL_LogWarn(0, "Failed to create pipeline cache, pipelines will be compiled without one");
+		m_Cache = nullptr;
+		m_Warm = false;
+	}
+}
+
+void PipelineCache::Save() const {
+	if (m_Cache == nullptr || m_Path.empty()) {
+		return;
+	}
+	size_t size = 0;
+	if (vkGetPipelineCacheData(m_Device, m_Cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+		return;
+	}
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(m_Device, m_Cache, &size, data.data()) != VK_SUCCESS) {
+		SDL_LogWarn(0, "Failed to get pipeline cache data");
+		return;
+	}
+
+	std::string tempPath = m_Path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open() || !file.write(data.data(), size)) {
+			SDL_LogWarn(0, "Failed to write pipeline cache %s", tempPath.c_str());
+			return;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, m_Path, error);
+	if (error) {
+		SDL_LogWarn(0, "Failed to replace pipeline cache %s: %s", m_Path.c_str(), error.message().c_str());
+		std::filesystem::remove(tempPath, error);
+	}
+}
+
+void PipelineCache::Destroy() {
+	if (m_Cache != nullptr) {
+		vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+		m_Cache = nullptr;
+	}
+}
+
+VkPipelineCache PipelineCache::GetHandle() const {
+	return m_Cache;
+}
+
+bool PipelineCache::IsWarm() const {
+	return m_Warm;
+}
\ No newline at end of file
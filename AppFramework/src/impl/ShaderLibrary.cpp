@@ -0,0 +1,125 @@
+#include <ShaderLibrary.h>
+#include <MappedFile.h>
+#include <CpuTrace.h>
+
+#include <SDL2/SDL.h>
+
+#include <cstring>
+
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+static bool IsSpirv(const void* code, size_t size) {
+	return size >= sizeof(uint32_t) && size % sizeof(uint32_t) == 0 && *static_cast<const uint32_t*>(code) == SPIRV_MAGIC;
+}
+
+void ShaderLibrary::Init(VkDevice device) {
+	m_Device = device;
+}
+
+void ShaderLibrary::Shutdown() {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (auto& [hash, entry] : m_Modules) {
+		vkDestroyShaderModule(m_Device, entry.module, nullptr);
+	}
+	m_Modules.clear();
+	m_Reflections.clear();
+}
+
+void ShaderLibrary::SetArchive(const AssetArchive* archive) {
+	m_Archive = archive;
+}
+
+VkShaderModule ShaderLibrary::Load(const char* path) {
+	TRACE_ZONE("LoadShader");
+	AssetArchive::Asset asset;
+	if (m_Archive != nullptr && m_Archive->Find(path, asset)) {
+		// The packer already hashed it, so only the comparison against a module with the same hash reads the rest of it
+		VkShaderModule module = IsSpirv(asset.data, asset.size) ? Create(asset.data, asset.size, asset.hash) : nullptr;
+		if (module == nullptr) {
+			SDL_LogError(0, "Failed to create a shader module from %s in the asset archive", path);
+		}
+		return module;
+	}
+	MappedFile file;
+	if (!file.Open(path)) {
+		SDL_LogError(0, "Failed to open %s, run from the directory holding the compiled shaders", path);
+		return nullptr;
+	}
+	// vkCreateShaderModule copies the code, so the file can be unmapped as soon as this returns
+	VkShaderModule module = Get(file.GetData(), file.GetSize());
+	if (module == nullptr) {
+		SDL_LogError(0, "Failed to create a shader module from %s", path);
+	}
+	return module;
+}
+
+VkShaderModule ShaderLibrary::Get(const void* code, size_t size) {
+	if (!IsSpirv(code, size)) {
+		return nullptr;
+	}
+	return Create(code, size, Hash(code, size));
+}
+
+VkShaderModule ShaderLibrary::Create(const void* code, size_t size, uint64_t hash) {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stats.loads++;
+		if (VkShaderModule found = FindLocked(code, size, hash)) {
+			m_Stats.hits++;
+			return found;
+		}
+	}
+	// Created outside the lock so loads of different shaders on other threads are not serialised behind the driver
+	VkShaderModuleCreateInfo moduleInfo{};
+	moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize = size;
+	moduleInfo.pCode = static_cast<const uint32_t*>(code);
+	VkShaderModule module = nullptr;
+	if (vkCreateShaderModule(m_Device, &moduleInfo, nullptr, &module) != VK_SUCCESS) {
+		return nullptr;
+	}
+	// Reflected once per distinct shader, every later load of it gets the result for free
+	ShaderReflection reflection;
+	bool reflected = reflection.Parse(code, size);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (VkShaderModule existing = FindLocked(code, size, hash)) {
+		// Another thread created the same module first, keep one
+		vkDestroyShaderModule(m_Device, module, nullptr);
+		m_Stats.hits++;
+		return existing;
+	}
+	const uint32_t* words = static_cast<const uint32_t*>(code);
+	m_Modules.emplace(hash, Module{ std::vector<uint32_t>(words, words + size / sizeof(uint32_t)), module });
+	if (reflected) {
+		m_Reflections.emplace(module, std::move(reflection));
+	}
+	m_Stats.modules++;
+	return module;
+}
+
+VkShaderModule ShaderLibrary::FindLocked(const void* code, size_t size, uint64_t hash) const {
+	auto [first, last] = m_Modules.equal_range(hash);
+	for (auto it = first; it != last; ++it) {
+		const std::vector<uint32_t>& existing = it->second.code;
+		if (existing.size() * sizeof(uint32_t) == size && memcmp(existing.data(), code, size) == 0) {
+			return it->second.module;
+		}
+	}
+	return nullptr;
+}
+
+const ShaderReflection* ShaderLibrary::GetReflection(VkShaderModule module) const {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto found = m_Reflections.find(module);
+	return found != m_Reflections.end() ? &found->second : nullptr;
+}
+
+ShaderLibrary::Stats ShaderLibrary::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+uint64_t ShaderLibrary::Hash(const void* code, size_t size) {
+	// The same hash the asset packer stores, so shaders from the archive and from loose files share modules
+	return AssetContentHash(code, size);
+}
\ No newline at end of file
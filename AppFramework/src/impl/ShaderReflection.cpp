@@ -0,0 +1,446 @@
+#include <ShaderReflection.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+	constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+	// The few opcodes, decorations and storage classes the reflection needs, numbered as in the SPIR-V specification
+	enum Op : uint32_t {
+		OpEntryPoint = 15,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeMatrix = 24,
+		OpTypeImage = 25,
+		OpTypeSampler = 26,
+		OpTypeSampledImage = 27,
+		OpTypeArray = 28,
+		OpTypeRuntimeArray = 29,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpConstant = 43,
+		OpVariable = 59,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+		OpTypeAccelerationStructureKHR = 5341
+	};
+	enum Decoration : uint32_t {
+		DecorationBlock = 2,
+		DecorationBufferBlock = 3,
+		DecorationArrayStride = 6,
+		DecorationMatrixStride = 7,
+		DecorationBuiltIn = 11,
+		DecorationLocation = 30,
+		DecorationBinding = 33,
+		DecorationDescriptorSet = 34,
+		DecorationOffset = 35
+	};
+	enum StorageClass : uint32_t {
+		StorageClassUniformConstant = 0,
+		StorageClassInput = 1,
+		StorageClassUniform = 2,
+		StorageClassPushConstant = 9,
+		StorageClassStorageBuffer = 12
+	};
+	constexpr uint32_t IMAGE_DIM_BUFFER = 5;
+	constexpr uint32_t IMAGE_DIM_SUBPASS_DATA = 6;
+	// Deep enough for any real shader, and stops malformed modules with cyclic types
+	constexpr uint32_t MAX_TYPE_DEPTH = 32;
+
+	// What the module says about one result id
+	struct SpirvId {
+		// The instruction defining the id, 0 when it was never defined
+		uint32_t opcode = 0;
+		uint32_t word = 0;
+		uint32_t set = UINT32_MAX;
+		uint32_t binding = UINT32_MAX;
+		uint32_t location = UINT32_MAX;
+		uint32_t arrayStride = 0;
+		bool builtIn = false;
+		bool block = false;
+		bool bufferBlock = false;
+	};
+	struct SpirvMember {
+		uint32_t offset = 0;
+		uint32_t matrixStride = 0;
+	};
+
+	class SpirvModule {
+	public:
+		const uint32_t* words = nullptr;
+		size_t wordCount = 0;
+		std::vector<SpirvId> ids;
+		// Keyed by struct id in the high half and member index in the low half
+		std::unordered_map<uint64_t, SpirvMember> members;
+
+		// Operand i of the instruction defining id, counted from the opcode word
+		uint32_t Operand(uint32_t id, uint32_t i) const {
+			const SpirvId& info = ids[id];
+			uint32_t length = words[info.word] >> 16;
+			return i < length ? words[info.word + i] : 0;
+		}
+		uint32_t OperandCount(uint32_t id) const {
+			return words[ids[id].word] >> 16;
+		}
+		bool IsType(uint32_t id, uint32_t opcode) const {
+			return id < ids.size() && ids[id].opcode == opcode;
+		}
+		const SpirvMember* Member(uint32_t structId, uint32_t index) const {
+			auto found = members.find((uint64_t(structId) << 32) | index);
+			return found != members.end() ? &found->second : nullptr;
+		}
+		// Bytes a value of the type takes in a block laid out by its Offset, ArrayStride and MatrixStride decorations
+		uint32_t Size(uint32_t typeId, uint32_t matrixStride, uint32_t depth = 0) const {
+			if (typeId >= ids.size() || depth > MAX_TYPE_DEPTH) {
+				return 0;
+			}
+			switch (ids[typeId].opcode) {
+			case OpTypeInt:
+			case OpTypeFloat:
+				return Operand(typeId, 2) / 8;
+			case OpTypeVector:
+				return Operand(typeId, 3) * Size(Operand(typeId, 2), 0, depth + 1);
+			case OpTypeMatrix:
+				return Operand(typeId, 3) * (matrixStride != 0 ? matrixStride : Size(Operand(typeId, 2), 0, depth + 1));
+			case OpTypeArray: {
+				uint32_t length = ArrayLength(typeId);
+				uint32_t stride = ids[typeId].arrayStride;
+				return length * (stride != 0 ? stride : Size(Operand(typeId, 2), matrixStride, depth + 1));
+			}
+			case OpTypeStruct: {
+				uint32_t size = 0;
+				for (uint32_t i = 2; i < OperandCount(typeId); i++) {
+					const SpirvMember* member = Member(typeId, i - 2);
+					uint32_t offset = member != nullptr ? member->offset : 0;
+					size = std::max(size, offset + Size(Operand(typeId, i), member != nullptr ? member->matrixStride : 0, depth + 1));
+				}
+				return size;
+			}
+			default:
+				// Runtime arrays have no size of their own
+				return 0;
+			}
+		}
+		uint32_t ArrayLength(uint32_t arrayId) const {
+			uint32_t lengthId = Operand(arrayId, 3);
+			return IsType(lengthId, OpConstant) ? Operand(lengthId, 3) : 0;
+		}
+	};
+
+	VkShaderStageFlags StageFromExecutionModel(uint32_t model) {
+		switch (model) {
+		case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+		case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+		default: return 0;
+		}
+	}
+
+	VkFormat InputFormat(const SpirvModule& module, uint32_t typeId) {
+		uint32_t components = 1;
+		if (module.IsType(typeId, OpTypeVector)) {
+			components = module.Operand(typeId, 3);
+			typeId = module.Operand(typeId, 2);
+		}
+		if (components < 1 || components > 4 || (!module.IsType(typeId, OpTypeFloat) && !module.IsType(typeId, OpTypeInt)) || module.Operand(typeId, 2) != 32) {
+			return VK_FORMAT_UNDEFINED;
+		}
+		static const VkFormat formats[3][4] = {
+			{ VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+			{ VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT },
+			{ VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT }
+		};
+		uint32_t kind = module.IsType(typeId, OpTypeFloat) ? 0 : module.Operand(typeId, 3) != 0 ? 1 : 2;
+		return formats[kind][components - 1];
+	}
+
+	// Matrices and arrays take one location per column or element
+	void AddInputs(const SpirvModule& module, uint32_t typeId, uint32_t& location, std::vector<ShaderReflection::Input>& inputs, uint32_t depth = 0) {
+		if (depth > MAX_TYPE_DEPTH) {
+			return;
+		}
+		if (module.IsType(typeId, OpTypeArray)) {
+			for (uint32_t i = 0; i < module.ArrayLength(typeId); i++) {
+				AddInputs(module, module.Operand(typeId, 2), location, inputs, depth + 1);
+			}
+		}
+		else if (module.IsType(typeId, OpTypeMatrix)) {
+			for (uint32_t i = 0; i < module.Operand(typeId, 3); i++) {
+				inputs.push_back({ location++, InputFormat(module, module.Operand(typeId, 2)) });
+			}
+		}
+		else {
+			inputs.push_back({ location++, InputFormat(module, typeId) });
+		}
+	}
+
+	VkDescriptorType DescriptorType(const SpirvModule& module, uint32_t storageClass, uint32_t typeId) {
+		if (storageClass == StorageClassStorageBuffer) {
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+		if (storageClass == StorageClassUniform) {
+			// Older SPIR-V marks storage buffers as uniform blocks decorated BufferBlock
+			return module.ids[typeId].bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+		if (storageClass != StorageClassUniformConstant) {
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+		switch (module.ids[typeId].opcode) {
+		case OpTypeSampler:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+		case OpTypeSampledImage:
+			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		case OpTypeImage: {
+			// Sampled is 1 for images read through a sampler and 2 for storage images
+			uint32_t dim = module.Operand(typeId, 3);
+			bool storage = module.Operand(typeId, 7) == 2;
+			if (dim == IMAGE_DIM_BUFFER) {
+				return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+			}
+			if (dim == IMAGE_DIM_SUBPASS_DATA) {
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			}
+			return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		}
+		case OpTypeAccelerationStructureKHR:
+			return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+		default:
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+	}
+
+	uint32_t FormatSize(VkFormat format) {
+		switch (format) {
+		case VK_FORMAT_R32_SFLOAT: case VK_FORMAT_R32_SINT: case VK_FORMAT_R32_UINT: return 4;
+		case VK_FORMAT_R32G32_SFLOAT: case VK_FORMAT_R32G32_SINT: case VK_FORMAT_R32G32_UINT: return 8;
+		case VK_FORMAT_R32G32B32_SFLOAT: case VK_FORMAT_R32G32B32_SINT: case VK_FORMAT_R32G32B32_UINT: return 12;
+		case VK_FORMAT_R32G32B32A32_SFLOAT: case VK_FORMAT_R32G32B32A32_SINT: case VK_FORMAT_R32G32B32A32_UINT: return 16;
+		default: return 0;
+		}
+	}
+}
+
+bool ShaderReflection::Parse(const void* code, size_t size) {
+	*this = ShaderReflection();
+	SpirvModule module;
+	module.words = static_cast<const uint32_t*>(code);
+	module.wordCount = size / sizeof(uint32_t);
+	// Magic, version, generator, id bound and a reserved word
+	if (size % sizeof(uint32_t) != 0 || module.wordCount < 5 || module.words[0] != SPIRV_MAGIC || module.words[3] > (1u << 22)) {
+		return false;
+	}
+	module.ids.resize(module.words[3]);
+	std::vector<uint32_t> variables;
+	uint32_t executionModel = UINT32_MAX;
+	// One pass collects ids, decorations and variables, since decorations come before the types they decorate
+	for (size_t word = 5; word < module.wordCount;) {
+		uint32_t opcode = module.words[word] & 0xFFFF;
+		uint32_t length = module.words[word] >> 16;
+		if (length == 0 || word + length > module.wordCount) {
+			return false;
+		}
+		const uint32_t* operands = module.words + word;
+		// An id at or past the bound in the header makes the module malformed
+		auto define = [&](uint32_t id) {
+			if (id >= module.ids.size()) {
+				return false;
+			}
+			module.ids[id].opcode = opcode;
+			module.ids[id].word = static_cast<uint32_t>(word);
+			return true;
+		};
+		switch (opcode) {
+		case OpEntryPoint:
+			// Only the first entry point is reflected
+			if (executionModel == UINT32_MAX && length >= 2) {
+				executionModel = operands[1];
+			}
+			break;
+		case OpDecorate:
+			if (length >= 3 && operands[1] < module.ids.size()) {
+				SpirvId& target = module.ids[operands[1]];
+				uint32_t value = length >= 4 ? operands[3] : 0;
+				switch (operands[2]) {
+				case DecorationBlock: target.block = true; break;
+				case DecorationBufferBlock: target.bufferBlock = true; break;
+				case DecorationArrayStride: target.arrayStride = value; break;
+				case DecorationBuiltIn: target.builtIn = true; break;
+				case DecorationLocation: target.location = value; break;
+				case DecorationBinding: target.binding = value; break;
+				case DecorationDescriptorSet: target.set = value; break;
+				}
+			}
+			break;
+		case OpMemberDecorate:
+			if (length >= 5 && (operands[3] == DecorationOffset || operands[3] == DecorationMatrixStride)) {
+				SpirvMember& member = module.members[(uint64_t(operands[1]) << 32) | operands[2]];
+				(operands[3] == DecorationOffset ? member.offset : member.matrixStride) = operands[4];
+			}
+			break;
+		case OpTypeInt:
+		case OpTypeFloat:
+		case OpTypeVector:
+		case OpTypeMatrix:
+		case OpTypeImage:
+		case OpTypeSampler:
+		case OpTypeSampledImage:
+		case OpTypeArray:
+		case OpTypeRuntimeArray:
+		case OpTypeStruct:
+		case OpTypePointer:
+		case OpTypeAccelerationStructureKHR:
+			if (length >= 2 && !define(operands[1])) {
+				return false;
+			}
+			break;
+		case OpConstant:
+			if (length >= 4 && !define(operands[2])) {
+				return false;
+			}
+			break;
+		case OpVariable:
+			if (length >= 4) {
+				if (!define(operands[2])) {
+					return false;
+				}
+				variables.push_back(operands[2]);
+			}
+			break;
+		}
+		word += length;
+	}
+	stages = StageFromExecutionModel(executionModel);
+	if (stages == 0) {
+		return false;
+	}
+
+	uint32_t pushConstantEnd = 0;
+	for (uint32_t variable : variables) {
+		uint32_t pointerType = module.Operand(variable, 1);
+		uint32_t storageClass = module.Operand(variable, 3);
+		if (!module.IsType(pointerType, OpTypePointer)) {
+			return false;
+		}
+		uint32_t typeId = module.Operand(pointerType, 3);
+		if (typeId >= module.ids.size()) {
+			return false;
+		}
+		const SpirvId& info = module.ids[variable];
+		if (storageClass == StorageClassInput) {
+			if (stages == VK_SHADER_STAGE_VERTEX_BIT && !info.builtIn && info.location != UINT32_MAX) {
+				uint32_t location = info.location;
+				AddInputs(module, typeId, location, inputs);
+			}
+			continue;
+		}
+		if (storageClass == StorageClassPushConstant) {
+			if (!module.IsType(typeId, OpTypeStruct)) {
+				return false;
+			}
+			// The block may start past 0 when another stage owns the space before it
+			uint32_t offset = UINT32_MAX;
+			for (uint32_t i = 2; i < module.OperandCount(typeId); i++) {
+				const SpirvMember* member = module.Member(typeId, i - 2);
+				offset = std::min(offset, member != nullptr ? member->offset : 0);
+			}
+			pushConstants.stageFlags = stages;
+			pushConstants.offset = offset == UINT32_MAX ? 0 : offset;
+			pushConstantEnd = module.Size(typeId, 0);
+			continue;
+		}
+		if (info.set == UINT32_MAX || info.binding == UINT32_MAX) {
+			continue;
+		}
+		Binding binding;
+		binding.set = info.set;
+		binding.binding = info.binding;
+		binding.stages = stages;
+		for (uint32_t depth = 0; depth <= MAX_TYPE_DEPTH; depth++) {
+			if (module.IsType(typeId, OpTypeArray)) {
+				binding.count *= module.ArrayLength(typeId);
+			}
+			else if (module.IsType(typeId, OpTypeRuntimeArray)) {
+				binding.count = 0;
+			}
+			else {
+				break;
+			}
+			typeId = module.Operand(typeId, 2);
+			if (typeId >= module.ids.size()) {
+				return false;
+			}
+		}
+		binding.type = DescriptorType(module, storageClass, typeId);
+		if (binding.type == VK_DESCRIPTOR_TYPE_MAX_ENUM) {
+			return false;
+		}
+		bindings.push_back(binding);
+	}
+	if (pushConstantEnd > pushConstants.offset) {
+		// Ranges are counted in whole words
+		pushConstants.size = (pushConstantEnd - pushConstants.offset + 3) & ~3u;
+	}
+	else {
+		pushConstants = {};
+	}
+	std::sort(bindings.begin(), bindings.end(), [](const Binding& a, const Binding& b) {
+		return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+	});
+	std::sort(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) {
+		return a.location < b.location;
+	});
+	return true;
+}
+
+bool ShaderReflection::Merge(const ShaderReflection& other) {
+	for (const Binding& binding : other.bindings) {
+		auto found = std::find_if(bindings.begin(), bindings.end(), [&binding](const Binding& existing) {
+			return existing.set == binding.set && existing.binding == binding.binding;
+		});
+		if (found == bindings.end()) {
+			bindings.push_back(binding);
+			continue;
+		}
+		if (found->type != binding.type) {
+			return false;
+		}
+		found->stages |= binding.stages;
+		// Runtime sized in either stage stays runtime sized
+		found->count = found->count == 0 || binding.count == 0 ? 0 : std::max(found->count, binding.count);
+	}
+	std::sort(bindings.begin(), bindings.end(), [](const Binding& a, const Binding& b) {
+		return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+	});
+	if (other.stages & VK_SHADER_STAGE_VERTEX_BIT) {
+		inputs = other.inputs;
+	}
+	if (other.pushConstants.size > 0) {
+		if (pushConstants.size == 0) {
+			pushConstants = other.pushConstants;
+		}
+		else {
+			uint32_t end = std::max(pushConstants.offset + pushConstants.size, other.pushConstants.offset + other.pushConstants.size);
+			pushConstants.offset = std::min(pushConstants.offset, other.pushConstants.offset);
+			pushConstants.size = end - pushConstants.offset;
+			pushConstants.stageFlags |= other.pushConstants.stageFlags;
+		}
+	}
+	stages |= other.stages;
+	return true;
+}
+
+void ShaderReflection::GetVertexInput(uint32_t binding, VkVertexInputBindingDescription& description, std::vector<VkVertexInputAttributeDescription>& attributes) const {
+	description = { binding, 0, VK_VERTEX_INPUT_RATE_VERTEX };
+	attributes.clear();
+	for (const Input& input : inputs) {
+		if (input.format == VK_FORMAT_UNDEFINED) {
+			continue;
+		}
+		attributes.push_back({ input.location, binding, input.format, description.stride });
+		description.stride += FormatSize(input.format);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <Timeline.h>
+
+#include <SDL2/SDL.h>
+
+#include <iterator>
+
+bool Timeline::Init(VkDevice device, const char* name) {
+	m_Device = device;
+	m_NextValue = 1;
+	m_Completed = 0;
+	VkSemaphoreTypeCreateInfo typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+	if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Semaphore) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create %s timeline semaphore!", name);
+		return false;
+	}
+	return true;
+}
+
+void Timeline::Shutdown() {
+	if (m_Semaphore == nullptr) {
+		return;
+	}
+	Wait(GetLastSignaled());
+	// Callbacks keyed to values that will never be signaled now are run as well, nothing is left on the GPU
+	std::deque<std::pair<uint64_t, std::function<void()>>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		callbacks.swap(m_Callbacks);
+	}
+	for (auto& callback : callbacks) {
+		callback.second();
+	}
+	vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+	m_Semaphore = nullptr;
+}
+
+uint64_t Timeline::Signal() {
+	return m_NextValue++;
+}
+
+void Timeline::SignalOnHost(uint64_t value) {
+	// Values only move forward, so the GPU has to reach every earlier one before this can be set
+	Wait(value - 1);
+	VkSemaphoreSignalInfo signalInfo{};
+	signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+	signalInfo.semaphore = m_Semaphore;
+	signalInfo.value = value;
+	if (vkSignalSemaphore(m_Device, &signalInfo) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to signal timeline value %llu from the host!", static_cast<unsigned long long>(value));
+	}
+}
+
+uint64_t Timeline::GetPendingValue() const {
+	return m_NextValue;
+}
+
+uint64_t Timeline::GetLastSignaled() const {
+	return m_NextValue - 1;
+}
+
+uint64_t Timeline::GetCompleted() const {
+	uint64_t completed = 0;
+	vkGetSemaphoreCounterValue(m_Device, m_Semaphore, &completed);
+	m_Completed = completed;
+	return completed;
+}
+
+bool Timeline::IsComplete(uint64_t value) const {
+	return value <= m_Completed || value <= GetCompleted();
+}
+
+void Timeline::Wait(uint64_t value) const {
+	if (value <= m_Completed) {
+		return;
+	}
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &m_Semaphore;
+	waitInfo.pValues = &value;
+	vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX);
+	GetCompleted();
+}
+
+void Timeline::OnComplete(uint64_t value, std::function<void()> callback) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	// Values are usually handed out in order, so this is almost always an append
+	auto position = m_Callbacks.end();
+	while (position != m_Callbacks.begin() && std::prev(position)->first > value) {
+		position--;
+	}
+	m_Callbacks.insert(position, { value, std::move(callback) });
+}
+
+void Timeline::Collect() {
+	uint64_t completed = GetCompleted();
+	std::vector<std::function<void()>> ready;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		while (!m_Callbacks.empty() && m_Callbacks.front().first <= completed) {
+			ready.push_back(std::move(m_Callbacks.front().second));
+			m_Callbacks.pop_front();
+		}
+	}
+	// Called without the lock so a callback can queue more work
+	for (auto& callback : ready) {
+		callback();
+	}
+}
+
+VkSemaphore Timeline::GetSemaphore() const {
+	return m_Semaphore;
+}
+
+void TimelineSubmit::Wait(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags stage) {
+	m_WaitSemaphores.push_back(semaphore);
+	m_WaitValues.push_back(value);
+	m_WaitStages.push_back(stage);
+}
+
+void TimelineSubmit::Signal(VkSemaphore semaphore, uint64_t value) {
+	m_SignalSemaphores.push_back(semaphore);
+	m_SignalValues.push_back(value);
+}
+
+VkResult TimelineSubmit::Submit(VkQueue queue, VkCommandBuffer commandBuffer) const {
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(m_WaitValues.size());
+	timelineInfo.pWaitSemaphoreValues = m_WaitValues.data();
+	timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(m_SignalValues.size());
+	timelineInfo.pSignalSemaphoreValues = m_SignalValues.data();
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(m_WaitSemaphores.size());
+	submitInfo.pWaitSemaphores = m_WaitSemaphores.data();
+	submitInfo.pWaitDstStageMask = m_WaitStages.data();
+	submitInfo.commandBufferCount = commandBuffer != nullptr ? 1 : 0;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(m_SignalSemaphores.size());
+	submitInfo.pSignalSemaphores = m_SignalSemaphores.data();
+	return vkQueueSubmit(queue, 1, &submitInfo, nullptr);
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include <TlsfBlock.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#pragma region Utilities
+static uint32_t FindFirstSet(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+static uint32_t FindLastSet(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return index;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool OnSamePage(uint64_t lastByte, uint64_t firstByte, uint64_t pageSize) {
+	return (lastByte & ~(pageSize - 1)) == (firstByte & ~(pageSize - 1));
+}
+#pragma endregion
+
+TlsfBlock::TlsfBlock(uint64_t size, uint64_t granularity) : m_Size(size), m_Granularity(granularity > 0 ? granularity : 1) {
+	for (auto& heads : m_Heads) {
+		for (uint32_t& head : heads) {
+			head = NIL;
+		}
+	}
+	uint32_t node = NewNode();
+	m_Nodes[node].size = size;
+	InsertFree(node);
+}
+
+bool TlsfBlock::Allocate(uint64_t size, uint64_t alignment, ResourceKind kind, TlsfAllocation& allocation) {
+	if (size == 0) {
+		return false;
+	}
+	alignment = alignment > 0 ? alignment : 1;
+	// Search for a size that fits regardless of where the block starts, including granularity padding on both ends
+	uint64_t pageAlignment = alignment > m_Granularity ? alignment : m_Granularity;
+	uint64_t searchSize = size + alignment - 1;
+	if (m_Granularity > 1) {
+		searchSize = size + pageAlignment - 1 + m_Granularity - 1;
+	}
+	uint32_t node = FindFree(searchSize);
+	if (node == NIL) {
+		return false;
+	}
+	RemoveFree(node);
+	Node block = m_Nodes[node];
+
+	uint64_t offset = AlignUp(block.offset, alignment);
+	if (m_Granularity > 1 && Conflicts(block.prevPhysical, kind)) {
+		const Node& prev = m_Nodes[block.prevPhysical];
+		if (OnSamePage(prev.offset + prev.size - 1, offset, m_Granularity)) {
+			offset = AlignUp(offset, pageAlignment);
+		}
+	}
+	uint64_t end = offset + size;
+	if (m_Granularity > 1 && Conflicts(block.nextPhysical, kind)) {
+		if (OnSamePage(end - 1, m_Nodes[block.nextPhysical].offset, m_Granularity)) {
+			end = AlignUp(end, m_Granularity);
+		}
+	}
+
+	// Padding in front stays free as its own range
+	if (offset > block.offset) {
+		uint32_t padding = NewNode();
+		Node& front = m_Nodes[padding];
+		front.offset = block.offset;
+		front.size = offset - block.offset;
+		front.prevPhysical = block.prevPhysical;
+		front.nextPhysical = node;
+		if (block.prevPhysical != NIL) {
+			m_Nodes[block.prevPhysical].nextPhysical = padding;
+		}
+		m_Nodes[node].prevPhysical = padding;
+		InsertFree(padding);
+	}
+	uint64_t blockEnd = block.offset + block.size;
+	if (end < blockEnd) {
+		uint32_t remainder = NewNode();
+		Node& back = m_Nodes[remainder];
+		back.offset = end;
+		back.size = blockEnd - end;
+		back.prevPhysical = node;
+		back.nextPhysical = block.nextPhysical;
+		if (block.nextPhysical != NIL) {
+			m_Nodes[block.nextPhysical].prevPhysical = remainder;
+		}
+		m_Nodes[node].nextPhysical = remainder;
+		InsertFree(remainder);
+	}
+
+	Node& used = m_Nodes[node];
+	used.offset = offset;
+	used.size = end - offset;
+	used.kind = kind;
+	used.free = false;
+	m_Used += used.size;
+	m_AllocationCount++;
+
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.node = node;
+	return true;
+}
+
+void TlsfBlock::Free(const TlsfAllocation& allocation) {
+	uint32_t node = allocation.node;
+	m_Used -= m_Nodes[node].size;
+	m_AllocationCount--;
+	m_Nodes[node].free = true;
+
+	uint32_t prev = m_Nodes[node].prevPhysical;
+	if (prev != NIL && m_Nodes[prev].free) {
+		RemoveFree(prev);
+		m_Nodes[prev].size += m_Nodes[node].size;
+		m_Nodes[prev].nextPhysical = m_Nodes[node].nextPhysical;
+		if (m_Nodes[node].nextPhysical != NIL) {
+			m_Nodes[m_Nodes[node].nextPhysical].prevPhysical = prev;
+		}
+		ReleaseNode(node);
+		node = prev;
+	}
+	uint32_t next = m_Nodes[node].nextPhysical;
+	if (next != NIL && m_Nodes[next].free) {
+		RemoveFree(next);
+		m_Nodes[node].size += m_Nodes[next].size;
+		m_Nodes[node].nextPhysical = m_Nodes[next].nextPhysical;
+		if (m_Nodes[next].nextPhysical != NIL) {
+			m_Nodes[m_Nodes[next].nextPhysical].prevPhysical = node;
+		}
+		ReleaseNode(next);
+	}
+	InsertFree(node);
+}
+
+bool TlsfBlock::IsEmpty() const {
+	return m_AllocationCount == 0;
+}
+
+uint64_t TlsfBlock::GetSize() const {
+	return m_Size;
+}
+
+TlsfStats TlsfBlock::GetStats() const {
+	TlsfStats stats;
+	stats.size = m_Size;
+	stats.used = m_Used;
+	stats.allocationCount = m_AllocationCount;
+	for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+		for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+			for (uint32_t node = m_Heads[fl][sl]; node != NIL; node = m_Nodes[node].nextFree) {
+				stats.freeRangeCount++;
+				if (m_Nodes[node].size > stats.largestFree) {
+					stats.largestFree = m_Nodes[node].size;
+				}
+			}
+		}
+	}
+	return stats;
+}
+
+uint32_t TlsfBlock::NewNode() {
+	if (!m_UnusedNodes.empty()) {
+		uint32_t node = m_UnusedNodes.back();
+		m_UnusedNodes.pop_back();
+		m_Nodes[node] = Node{};
+		return node;
+	}
+	m_Nodes.emplace_back();
+	return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
+
+void TlsfBlock::ReleaseNode(uint32_t node) {
+	m_UnusedNodes.push_back(node);
+}
+
+void TlsfBlock::InsertFree(uint32_t node) {
+	uint32_t fl, sl;
+	Mapping(m_Nodes[node].size, fl, sl);
+	uint32_t head = m_Heads[fl][sl];
+	m_Nodes[node].free = true;
+	m_Nodes[node].prevFree = NIL;
+	m_Nodes[node].nextFree = head;
+	if (head != NIL) {
+		m_Nodes[head].prevFree = node;
+	}
+	m_Heads[fl][sl] = node;
+	m_FlBitmap |= 1ULL << fl;
+	m_SlBitmaps[fl] |= 1U << sl;
+}
+
+void TlsfBlock::RemoveFree(uint32_t node) {
+	uint32_t fl, sl;
+	Mapping(m_Nodes[node].size, fl, sl);
+	const Node& removed = m_Nodes[node];
+	if (removed.prevFree != NIL) {
+		m_Nodes[removed.prevFree].nextFree = removed.nextFree;
+	}
+	else {
+		m_Heads[fl][sl] = removed.nextFree;
+	}
+	if (removed.nextFree != NIL) {
+		m_Nodes[removed.nextFree].prevFree = removed.prevFree;
+	}
+	if (m_Heads[fl][sl] == NIL) {
+		m_SlBitmaps[fl] &= ~(1U << sl);
+		if (m_SlBitmaps[fl] == 0) {
+			m_FlBitmap &= ~(1ULL << fl);
+		}
+	}
+}
+
+// Rounds the request up to the next list boundary so any range found is large enough without walking the list
+uint32_t TlsfBlock::FindFree(uint64_t size) const {
+	// Small lists are SMALL_SIZE / SL_COUNT wide, the same rounding keeps a request from landing in a list of smaller ranges
+	uint64_t round = size >= SMALL_SIZE ? (1ULL << (FindLastSet(size) - SL_COUNT_LOG2)) - 1 : SMALL_SIZE / SL_COUNT - 1;
+	if (size > UINT64_MAX - round) {
+		return NIL;
+	}
+	size += round;
+	uint32_t fl, sl;
+	Mapping(size, fl, sl);
+	if (fl >= FL_COUNT) {
+		return NIL;
+	}
+	uint32_t slMap = m_SlBitmaps[fl] & (~0U << sl);
+	if (slMap == 0) {
+		uint64_t flMap = fl + 1 < 64 ? m_FlBitmap & (~0ULL << (fl + 1)) : 0;
+		if (flMap == 0) {
+			return NIL;
+		}
+		fl = FindFirstSet(flMap);
+		slMap = m_SlBitmaps[fl];
+	}
+	return m_Heads[fl][FindFirstSet(slMap)];
+}
+
+bool TlsfBlock::Conflicts(uint32_t node, ResourceKind kind) const {
+	return node != NIL && !m_Nodes[node].free && m_Nodes[node].kind != kind;
+}
+
+void TlsfBlock::Mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+	if (size < SMALL_SIZE) {
+		fl = 0;
+		sl = static_cast<uint32_t>(size / (SMALL_SIZE / SL_COUNT));
+		return;
+	}
+	uint32_t last = FindLastSet(size);
+	sl = static_cast<uint32_t>(size >> (last - SL_COUNT_LOG2)) ^ SL_COUNT;
+	fl = last - (FL_SHIFT - 1);
+}
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include <UploadEngine.h>
+#include <CpuTrace.h>
+
+#include <SDL2/SDL.h>
+
+#include <cstring>
+
+// Satisfies every texel block size as well as the usual optimalBufferCopyOffsetAlignment
+constexpr VkDeviceSize COPY_ALIGNMENT = 256;
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+void UploadEngine::Init(VkDevice device, MemoryAllocator& allocator, uint32_t transferFamily, VkQueue transferQueue, uint32_t graphicsFamily, std::mutex* queueMutex, VkDeviceSize ringSize) {
+	m_Device = device;
+	m_Allocator = &allocator;
+	m_TransferFamily = transferFamily;
+	m_Queue = transferQueue;
+	m_GraphicsFamily = graphicsFamily;
+	m_QueueMutex = queueMutex;
+	m_RingSize = ringSize;
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_TransferFamily;
+	if (vkCreateCommandPool(m_Device, &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS) {
+		SDL_LogError(0, "Failed to create upload command pool!");
+	}
+
+	m_Timeline.Init(m_Device, "upload");
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = m_RingSize;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (!m_Allocator->CreateBuffer(bufferInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_Staging, m_StagingMemory)) {
+		SDL_LogError(0, "Failed to create upload staging ring!");
+	}
+	SDL_Log("Uploads use %s transfer queue with a %.0fMB staging ring", NeedsOwnershipTransfer() ? "a dedicated" : "the graphics", m_RingSize / (1024.0 * 1024.0));
+}
+
+void UploadEngine::Shutdown() {
+	if (m_Device == nullptr) {
+		return;
+	}
+	m_Timeline.Shutdown();
+	vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
+	m_Allocator->DestroyBuffer(m_Staging, m_StagingMemory);
+	m_InFlight.clear();
+	m_FreeCommandBuffers.clear();
+	m_PendingAcquires.clear();
+	m_Device = nullptr;
+}
+
+uint64_t UploadEngine::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	// Nothing would be recorded, so the pending value might never be signaled
+	if (size == 0) {
+		return m_Timeline.GetLastSignaled();
+	}
+	// Large uploads go through in pieces so they never need the whole ring at once
+	VkDeviceSize chunkSize = m_RingSize / 4;
+	for (VkDeviceSize copied = 0; copied < size; copied += chunkSize) {
+		VkDeviceSize copySize = size - copied < chunkSize ? size - copied : chunkSize;
+		VkDeviceSize stagingOffset;
+		ReserveStaging(copySize, stagingOffset);
+		std::memcpy(static_cast<char*>(m_StagingMemory.mapped) + stagingOffset, static_cast<const char*>(data) + copied, copySize);
+		VkBufferCopy region{};
+		region.srcOffset = stagingOffset;
+		region.dstOffset = offset + copied;
+		region.size = copySize;
+		vkCmdCopyBuffer(BeginRecording(), m_Staging, buffer, 1, &region);
+	}
+
+	if (NeedsOwnershipTransfer()) {
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = m_TransferFamily;
+		barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+		// The release only makes the writes available, the acquire on the graphics queue makes them visible
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		m_BufferReleases.push_back(barrier);
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		m_RecordingAcquires.buffers.push_back(barrier);
+	}
+	return m_Timeline.GetPendingValue();
+}
+
+uint64_t UploadEngine::UploadImage(VkImage image, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	VkDeviceSize stagingOffset;
+	if (!ReserveStaging(size, stagingOffset)) {
+		SDL_LogError(0, "Image upload of %.2fMB does not fit the staging ring", size / (1024.0 * 1024.0));
+		return 0;
+	}
+	std::memcpy(static_cast<char*>(m_StagingMemory.mapped) + stagingOffset, data, size);
+	VkCommandBuffer commandBuffer = BeginRecording();
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = stagingOffset;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = extent;
+	vkCmdCopyBufferToImage(commandBuffer, m_Staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	// The transition to the final layout doubles as the release, the acquire repeats it on the graphics queue
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = finalLayout;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	if (NeedsOwnershipTransfer()) {
+		barrier.srcQueueFamilyIndex = m_TransferFamily;
+		barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+		m_ImageReleases.push_back(barrier);
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		m_RecordingAcquires.images.push_back(barrier);
+	}
+	else {
+		m_ImageReleases.push_back(barrier);
+	}
+	return m_Timeline.GetPendingValue();
+}
+
+uint64_t UploadEngine::Flush(bool blocking) {
+	std::unique_lock<std::mutex> lock(m_Mutex, std::defer_lock);
+	if (blocking) {
+		lock.lock();
+	}
+	else if (!lock.try_lock()) {
+		return 0;
+	}
+	return Submit();
+}
+
+bool UploadEngine::IsComplete(uint64_t value) const {
+	return m_Timeline.IsComplete(value);
+}
+
+void UploadEngine::Wait(uint64_t value) const {
+	m_Timeline.Wait(value);
+}
+
+uint64_t UploadEngine::AcquireCompleted(VkCommandBuffer commandBuffer) {
+	std::lock_guard<std::mutex> lock(m_AcquireMutex);
+	if (m_PendingAcquires.empty()) {
+		return 0;
+	}
+	// Only batches that already finished are taken, so the frame never stalls on the transfer queue
+	uint64_t completed = m_Timeline.GetCompleted();
+	uint64_t waitValue = 0;
+	std::vector<VkBufferMemoryBarrier> buffers;
+	std::vector<VkImageMemoryBarrier> images;
+	while (!m_PendingAcquires.empty() && m_PendingAcquires.front().value <= completed) {
+		Acquires& acquires = m_PendingAcquires.front();
+		buffers.insert(buffers.end(), acquires.buffers.begin(), acquires.buffers.end());
+		images.insert(images.end(), acquires.images.begin(), acquires.images.end());
+		waitValue = acquires.value;
+		m_PendingAcquires.pop_front();
+	}
+	if (!buffers.empty() || !images.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			0, nullptr, static_cast<uint32_t>(buffers.size()), buffers.data(), static_cast<uint32_t>(images.size()), images.data());
+	}
+	return waitValue;
+}
+
+VkSemaphore UploadEngine::GetSemaphore() const {
+	return m_Timeline.GetSemaphore();
+}
+
+bool UploadEngine::NeedsOwnershipTransfer() const {
+	return m_TransferFamily != m_GraphicsFamily;
+}
+
+VkCommandBuffer UploadEngine::BeginRecording() {
+	if (m_Recording.commandBuffer != nullptr) {
+		return m_Recording.commandBuffer;
+	}
+	Retire(false);
+	if (m_FreeCommandBuffers.empty()) {
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = m_CommandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer;
+		vkAllocateCommandBuffers(m_Device, &allocInfo, &commandBuffer);
+		m_FreeCommandBuffers.push_back(commandBuffer);
+	}
+	m_Recording.commandBuffer = m_FreeCommandBuffers.back();
+	m_FreeCommandBuffers.pop_back();
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(m_Recording.commandBuffer, &beginInfo);
+	return m_Recording.commandBuffer;
+}
+
+// Blocks the calling loader thread until the ring has room, by submitting and waiting for the oldest batch
+bool UploadEngine::ReserveStaging(VkDeviceSize size, VkDeviceSize& offset) {
+	if (size > m_RingSize) {
+		return false;
+	}
+	for (;;) {
+		uint64_t position = AlignUp(m_Head, COPY_ALIGNMENT);
+		if (position % m_RingSize + size > m_RingSize) {
+			position = AlignUp(position + 1, m_RingSize);
+		}
+		if (position + size - m_Tail <= m_RingSize) {
+			m_Head = position + size;
+			offset = position % m_RingSize;
+			return true;
+		}
+		if (m_InFlight.empty()) {
+			if (m_Recording.commandBuffer == nullptr) {
+				// Nothing references the ring, start over at its beginning
+				m_Head = m_Tail = AlignUp(m_Head, m_RingSize);
+				continue;
+			}
+			Submit();
+		}
+		Retire(true);
+	}
+}
+
+void UploadEngine::Retire(bool wait) {
+	if (wait && !m_InFlight.empty()) {
+		TRACE_ZONE("WaitForStaging");
+		Wait(m_InFlight.front().value);
+	}
+	uint64_t completed = m_Timeline.GetCompleted();
+	while (!m_InFlight.empty() && m_InFlight.front().value <= completed) {
+		Batch& batch = m_InFlight.front();
+		m_Tail = batch.ringEnd;
+		vkResetCommandBuffer(batch.commandBuffer, 0);
+		m_FreeCommandBuffers.push_back(batch.commandBuffer);
+		m_InFlight.pop_front();
+	}
+}
+
+uint64_t UploadEngine::Submit() {
+	if (m_Recording.commandBuffer == nullptr) {
+		return m_Timeline.GetLastSignaled();
+	}
+	VkCommandBuffer commandBuffer = m_Recording.commandBuffer;
+	if (!m_BufferReleases.empty() || !m_ImageReleases.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr, static_cast<uint32_t>(m_BufferReleases.size()), m_BufferReleases.data(), static_cast<uint32_t>(m_ImageReleases.size()), m_ImageReleases.data());
+		m_BufferReleases.clear();
+		m_ImageReleases.clear();
+	}
+	vkEndCommandBuffer(commandBuffer);
+
+	uint64_t value = m_Timeline.Signal();
+	TimelineSubmit submit;
+	submit.Signal(m_Timeline.GetSemaphore(), value);
+	{
+		std::unique_lock<std::mutex> queueLock;
+		if (m_QueueMutex != nullptr) {
+			queueLock = std::unique_lock<std::mutex>(*m_QueueMutex);
+		}
+		if (submit.Submit(m_Queue, commandBuffer) != VK_SUCCESS) {
+			SDL_LogError(0, "Failed to submit upload batch!");
+			// The batch is dropped, its data never lands but waits on its value return instead of hanging
+			m_Timeline.SignalOnHost(value);
+			vkResetCommandBuffer(commandBuffer, 0);
+			m_FreeCommandBuffers.push_back(commandBuffer);
+			m_Recording = Batch{};
+			m_RecordingAcquires = Acquires{};
+			return value;
+		}
+	}
+
+	m_Recording.value = value;
+	m_Recording.ringEnd = m_Head;
+	m_InFlight.push_back(m_Recording);
+	m_Recording = Batch{};
+
+	// Every batch gets an entry, even without barriers the frame still has to wait on its value to see the data
+	m_RecordingAcquires.value = value;
+	{
+		std::lock_guard<std::mutex> acquireLock(m_AcquireMutex);
+		m_PendingAcquires.push_back(std::move(m_RecordingAcquires));
+	}
+	m_RecordingAcquires = Acquires{};
+	return value;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+project "AssetPacker"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	targetdir "../bin/%{prj.name}/%{cfg.buildcfg}"
+	objdir "../obj/%{prj.name}/%{cfg.buildcfg}"
+	-- Only the archive code of the framework, so the packer builds without Vulkan or SDL
+	files { "src/**.cpp", "../AppFramework/include/AssetFormat.h", "../AppFramework/include/AssetArchive.h", "../AppFramework/include/MappedFile.h",
+		"../AppFramework/src/impl/AssetArchive.cpp", "../AppFramework/src/impl/MappedFile.cpp" }
+	includedirs "../AppFramework/include"
+	vpaths {
+		["Header"] = "**.h",
+		["Source"] = "**.cpp"
+	}
+	filter "configurations:Debug"
+		defines "DEBUG"
+		symbols "On"
+	filter "configurations:Release"
+		defines "NDEBUG"
+		optimize "On"
\ No newline at end of file
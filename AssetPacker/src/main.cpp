@@ -0,0 +1,49 @@
+#include <AssetArchive.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+// Packs files and whole directories into one asset archive at build time.
+// Assets are named by the path given on the command line, run it from the directory the application will run from.
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		fprintf(stderr, "Usage: AssetPacker <archive> <file or directory>...\n");
+		return EXIT_FAILURE;
+	}
+	std::filesystem::path output = std::filesystem::absolute(argv[1]);
+	std::vector<std::string> files;
+	for (int i = 2; i < argc; i++) {
+		std::error_code error;
+		if (std::filesystem::is_regular_file(argv[i], error)) {
+			files.push_back(argv[i]);
+			continue;
+		}
+		if (!std::filesystem::is_directory(argv[i], error)) {
+			fprintf(stderr, "%s is not a file or directory\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+		// Sorted so the archive is the same whatever order the file system lists the directory in
+		std::vector<std::string> directory;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[i])) {
+			if (entry.is_regular_file() && std::filesystem::absolute(entry.path()) != output) {
+				directory.push_back(entry.path().generic_string());
+			}
+		}
+		std::sort(directory.begin(), directory.end());
+		files.insert(files.end(), directory.begin(), directory.end());
+	}
+	if (!AssetArchive::Write(argv[1], files)) {
+		fprintf(stderr, "Failed to write %s, an input could not be read or two inputs have the same name\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	// Reading it back checks the index the way the applications will
+	AssetArchive archive;
+	if (!archive.Open(argv[1])) {
+		fprintf(stderr, "Failed to read back %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	printf("Packed %u assets into %s (%llu bytes)\n", archive.GetCount(), argv[1], static_cast<unsigned long long>(std::filesystem::file_size(argv[1])));
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
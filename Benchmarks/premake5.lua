@@ -0,0 +1,45 @@
+project "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	targetdir "../bin/%{prj.name}/%{cfg.buildcfg}"
+	objdir "../obj/%{prj.name}/%{cfg.buildcfg}"
+	dependson "AssetPacker"
+	-- Builds the framework sources directly, AppFramework is still an executable
+	files { "src/**.cpp", "src/**.h", "res/**.vert", "res/**.frag", "../AppFramework/include/**.h", "../AppFramework/src/impl/**.cpp" }
+	vpaths {
+		["Header"] = "**.h",
+		["Source"] = "**.cpp",
+		["Resource"] = { "**.vert", "**.frag" }
+	}
+
+	-- Prebuild commands to compile shaders and move them into the correct directory
+	prebuildcommands {
+		"{MKDIR} shaders",
+		"glslc res/bench.vert -o bench.vert.spv",
+		"{MOVE} bench.vert.spv shaders/bench.vert.spv",
+		"glslc res/bench.frag -o bench.frag.spv",
+		"{MOVE} bench.frag.spv shaders/bench.frag.spv",
+		"glslc res/bench_sets.frag -o bench_sets.frag.spv",
+		"{MOVE} bench_sets.frag.spv shaders/bench_sets.frag.spv",
+		"glslc res/bench_bindless.frag -o bench_bindless.frag.spv",
+		"{MOVE} bench_bindless.frag.spv shaders/bench_bindless.frag.spv",
+		"{COPYFILE} shaders ../bin/%{prj.name}/%{cfg.buildcfg}/shaders",
+		-- Packs the compiled shaders under the same names, loaded instead of the loose files when present
+		"\"../bin/AssetPacker/%{cfg.buildcfg}/AssetPacker\" assets.pak shaders",
+		"{COPYFILE} assets.pak ../bin/%{prj.name}/%{cfg.buildcfg}/assets.pak"
+	}
+
+	filter "system:windows"
+		includedirs { "$(VULKAN_SDK)/Include", "../AppFramework/include", "src" }
+		libdirs { "$(VULKAN_SDK)/Lib", "$(VULKAN_SDK)/Bin" }
+		links { "vulkan-1.lib", "SDL2.lib" }
+	filter "system:linux"
+		includedirs { "../AppFramework/include", "src" }
+		links { "vulkan", "SDL2", "pthread" }
+	filter "configurations:Debug"
+		defines "DEBUG"
+		symbols "On"
+	filter "configurations:Release"
+		defines "NDEBUG"
+		optimize "On"
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// The storage buffer array of the bindless heap
+layout (set = 0, binding = 1) readonly buffer Material {
+	vec4 color;
+} materials[];
+
+layout (push_constant) uniform Draw {
+	uint material;
+} draw;
+
+layout (location = 0) out vec4 outColor;
+
+void main() {
+	outColor = materials[draw.material].color;
+}
\ No newline at end of file
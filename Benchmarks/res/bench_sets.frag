@@ -0,0 +1,11 @@
+#version 450
+
+layout (set = 0, binding = 0) readonly buffer Material {
+	vec4 color;
+} material;
+
+layout (location = 0) out vec4 outColor;
+
+void main() {
+	outColor = material.color;
+}
\ No newline at end of file
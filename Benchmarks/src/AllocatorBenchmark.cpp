@@ -0,0 +1,114 @@
+#include <Benchmarks.h>
+#include <TlsfBlock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Exercises the sub-allocator on the CPU only, no device is needed
+BenchmarkResult RunAllocatorBenchmark(const BenchmarkOptions& options) {
+	constexpr uint64_t BLOCK_SIZE = 256ULL * 1024 * 1024;
+	constexpr uint64_t GRANULARITY = 1024;
+	constexpr uint32_t OPERATIONS = 1000000;
+	const uint64_t alignments[] = { 16, 256, 4096, 65536 };
+
+	std::mt19937_64 random(42);
+	TlsfBlock block(BLOCK_SIZE, GRANULARITY);
+	std::vector<TlsfAllocation> live;
+	live.reserve(OPERATIONS);
+	uint64_t liveBytes = 0;
+	// Sizes spread evenly over powers of two from 256B to 1MB, the way buffers and textures mix in practice
+	auto randomSize = [&]() {
+		uint64_t magnitude = 8 + random() % 13;
+		return (1ULL << magnitude) + random() % (1ULL << magnitude);
+	};
+	// Live allocations sharing any byte, always 0 unless the allocator hands out ranges that are too small
+	auto countOverlaps = [](std::vector<TlsfAllocation> allocations) {
+		std::sort(allocations.begin(), allocations.end(), [](const TlsfAllocation& a, const TlsfAllocation& b) { return a.offset < b.offset; });
+		uint32_t overlaps = 0;
+		for (size_t i = 1; i < allocations.size(); i++) {
+			overlaps += allocations[i - 1].offset + allocations[i - 1].size > allocations[i].offset ? 1 : 0;
+		}
+		return overlaps;
+	};
+	auto randomAllocate = [&]() {
+		TlsfAllocation allocation;
+		ResourceKind kind = random() % 2 ? ResourceKind::Linear : ResourceKind::Optimal;
+		if (block.Allocate(randomSize(), alignments[random() % 4], kind, allocation)) {
+			live.push_back(allocation);
+			liveBytes += allocation.size;
+			return true;
+		}
+		return false;
+	};
+
+	// Throughput with a steady mix of allocations and frees around half occupancy
+	uint32_t allocations = 0, frees = 0, failures = 0;
+	double allocateSeconds = 0, freeSeconds = 0;
+	for (uint32_t i = 0; i < OPERATIONS; i++) {
+		bool allocate = live.empty() || (liveBytes < BLOCK_SIZE / 2 ? random() % 4 != 0 : random() % 4 == 0);
+		if (allocate) {
+			auto start = std::chrono::high_resolution_clock::now();
+			bool success = randomAllocate();
+			allocateSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			allocations++;
+			failures += success ? 0 : 1;
+		}
+		else {
+			size_t index = random() % live.size();
+			TlsfAllocation allocation = live[index];
+			live[index] = live.back();
+			live.pop_back();
+			liveBytes -= allocation.size;
+			auto start = std::chrono::high_resolution_clock::now();
+			block.Free(allocation);
+			freeSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			frees++;
+		}
+	}
+	uint32_t overlaps = countOverlaps(live);
+	for (const auto& allocation : live) {
+		block.Free(allocation);
+	}
+	live.clear();
+
+	// Small buffers below the first level lists, with no granularity rounding to hide a range that is too short
+	TlsfBlock smallBlock(1024 * 1024, 1);
+	std::vector<TlsfAllocation> smallLive;
+	for (uint32_t i = 0; i < OPERATIONS / 10; i++) {
+		if (smallLive.empty() || random() % 2 == 0) {
+			TlsfAllocation allocation;
+			if (smallBlock.Allocate(1 + random() % 255, 1ULL << (random() % 5), ResourceKind::Linear, allocation)) {
+				smallLive.push_back(allocation);
+			}
+		}
+		else {
+			size_t index = random() % smallLive.size();
+			smallBlock.Free(smallLive[index]);
+			smallLive[index] = smallLive.back();
+			smallLive.pop_back();
+		}
+	}
+	overlaps += countOverlaps(smallLive);
+
+	// Fragmentation after filling the block and freeing every other allocation
+	while (randomAllocate()) {}
+	TlsfStats full = block.GetStats();
+	overlaps += countOverlaps(live);
+	for (size_t i = 0; i < live.size(); i += 2) {
+		block.Free(live[i]);
+	}
+	TlsfStats holed = block.GetStats();
+	uint64_t freeBytes = holed.size - holed.used;
+
+	return {
+		{ "allocate_ns", allocateSeconds * 1e9 / allocations },
+		{ "free_ns", freeSeconds * 1e9 / frees },
+		{ "failed_allocations", static_cast<double>(failures) },
+		{ "overlapping_allocations", static_cast<double>(overlaps) },
+		{ "fill_ratio", static_cast<double>(full.used) / full.size },
+		{ "free_ranges", static_cast<double>(holed.freeRangeCount) },
+		{ "fragmentation", freeBytes > 0 ? 1.0 - static_cast<double>(holed.largestFree) / freeBytes : 0.0 }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Named measurements from one scenario, printed as a JSON object.
+// Names ending in fps, _per_s or _ratio are rates where higher is better, everything else is a cost where lower is better.
+using BenchmarkResult = std::vector<std::pair<std::string, double>>;
+
+struct BenchmarkOptions {
+	uint64_t frames = 1000;
+	uint32_t draws = 10000;
+	uint32_t pipelines = 64;
+	uint32_t uploadMegabytes = 16;
+	uint32_t framesInFlight = 2;
+	uint32_t shaders = 512;
+};
+
+BenchmarkResult RunAllocatorBenchmark(const BenchmarkOptions& options);
+BenchmarkResult RunEmptyFrameBenchmark(const BenchmarkOptions& options);
+BenchmarkResult RunDrawBenchmark(const BenchmarkOptions& options);
+// The draw scenario recorded into secondary command buffers on every core
+BenchmarkResult RunParallelDrawBenchmark(const BenchmarkOptions& options);
+BenchmarkResult RunPipelineBenchmark(const BenchmarkOptions& options);
+BenchmarkResult RunUploadBenchmark(const BenchmarkOptions& options);
+BenchmarkResult RunStartupBenchmark(const BenchmarkOptions& options);
+// Repeats the draw scenario at every frames in flight depth to show how much CPU and GPU overlap
+BenchmarkResult RunFramesInFlightBenchmark(const BenchmarkOptions& options);
+// Reading a directory of SPIR-V into vectors against mapping it through the deduplicating shader library
+BenchmarkResult RunShaderLoadBenchmark(const BenchmarkOptions& options);
+// A simulation as costly as its draws, run with update and render in series and then pipelined
+BenchmarkResult RunPipelinedUpdateBenchmark(const BenchmarkOptions& options);
+// Per draw descriptor set allocation, write and bind against one bound bindless heap and a pushed index
+BenchmarkResult RunDescriptorBenchmark(const BenchmarkOptions& options);
+// Work-stealing parallel_for and job dispatch against std::async, no device is needed
+BenchmarkResult RunJobBenchmark(const BenchmarkOptions& options);
\ No newline at end of file
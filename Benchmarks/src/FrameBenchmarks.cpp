@@ -0,0 +1,563 @@
+#include <Benchmarks.h>
+#include <Application.h>
+
+#include <SDL2/SDL.h>
+
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+static std::vector<uint32_t> ReadShader(const std::string& path) {
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		SDL_LogError(0, "Failed to open %s, run from the directory holding the compiled shaders", path.c_str());
+		return {};
+	}
+	std::vector<uint32_t> code(static_cast<size_t>(file.tellg()) / sizeof(uint32_t));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(code.data()), code.size() * sizeof(uint32_t));
+	return code;
+}
+
+// Runs headless for a fixed number of frames with a cold pipeline cache so every run starts from the same state
+class BenchmarkApp : public Application {
+public:
+	BenchmarkApp(const char* title, const BenchmarkOptions& options, uint64_t frames) {
+		Title = title;
+		Width = 1280;
+		Height = 720;
+		Headless = true;
+		MaxFrames = frames;
+		FramesInFlight = options.framesInFlight;
+		PipelineCachePath = "";
+	}
+	virtual void OnCreate() override {}
+	virtual void OnUpdate(float dt) override {}
+	virtual void OnRender() override {}
+	BenchmarkResult GetResult() const {
+		const FrameStats& stats = GetFrameStats();
+		BenchmarkResult result = {
+			{ "fps", stats.seconds > 0 ? stats.frames / stats.seconds : 0 },
+			{ "cpu_avg_ms", stats.cpuAvgMs },
+			{ "cpu_p50_ms", stats.cpuP50Ms },
+			{ "cpu_p95_ms", stats.cpuP95Ms },
+			{ "cpu_p99_ms", stats.cpuP99Ms },
+			{ "cpu_max_ms", stats.cpuMaxMs },
+			{ "startup_ms", stats.startupMs },
+			{ "gpu_wait_ms", stats.gpuWaitMs },
+			{ "latency_avg_ms", stats.latencyAvgMs },
+			{ "latency_p99_ms", stats.latencyP99Ms }
+		};
+		result.insert(result.end(), m_Extra.begin(), m_Extra.end());
+		return result;
+	}
+protected:
+	// Scenario specific measurements appended to the frame statistics
+	BenchmarkResult m_Extra;
+	// The layout comes from the reflected shaders and belongs to the layout cache
+	GraphicsPipelineDesc CreatePipelineDesc(const char* fragmentPath = "shaders/bench.frag.spv") {
+		GraphicsPipelineDesc desc;
+		desc.vertexModule = GetShaderLibrary().Load("shaders/bench.vert.spv");
+		desc.fragmentModule = GetShaderLibrary().Load(fragmentPath);
+		desc.layout = GetLayoutCache().GetPipelineLayout({ GetShaderLibrary().GetReflection(desc.vertexModule), GetShaderLibrary().GetReflection(desc.fragmentModule) });
+		desc.renderPass = GetRenderPass();
+		return desc;
+	}
+	void SetViewport(VkCommandBuffer commandBuffer) {
+		VkExtent2D extent = GetExtent();
+		VkViewport viewport{ 0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f };
+		VkRect2D scissor{ { 0, 0 }, extent };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	}
+};
+
+class DrawBenchmark : public BenchmarkApp {
+public:
+	DrawBenchmark(const BenchmarkOptions& options, bool parallel = false) : BenchmarkApp("Draws", options, options.frames), m_Draws(options.draws), m_Parallel(parallel) {}
+	virtual void OnCreate() override {
+		m_Pipeline = GetPipelineBuilder().Build(CreatePipelineDesc()).get();
+		m_Extra.push_back({ "draws_per_s", 0 });
+	}
+	virtual void OnRender() override {
+		if (m_Parallel) {
+			// Secondary command buffers inherit no state, so every partition binds its own
+			RecordParallel(m_Draws, [this](VkCommandBuffer commandBuffer, uint32_t first, uint32_t last) {
+				RecordDraws(commandBuffer, last - first);
+			});
+		}
+		else {
+			RecordDraws(GetCommandBuffer(), m_Draws);
+		}
+	}
+	virtual void OnDestroy() override {
+		const FrameStats& stats = GetFrameStats();
+		m_Extra.back().second = stats.seconds > 0 ? static_cast<double>(m_Draws) * stats.frames / stats.seconds : 0;
+		vkDestroyPipeline(GetDevice(), m_Pipeline, nullptr);
+	}
+private:
+	uint32_t m_Draws;
+	bool m_Parallel;
+	VkPipeline m_Pipeline = nullptr;
+	void RecordDraws(VkCommandBuffer commandBuffer, uint32_t count) {
+		SetViewport(commandBuffer);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+		for (uint32_t i = 0; i < count; i++) {
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+	}
+};
+
+// Every pipeline gets a different combination of fixed function state so the driver compiles real variants
+class PipelineBenchmark : public BenchmarkApp {
+public:
+	PipelineBenchmark(const BenchmarkOptions& options) : BenchmarkApp("Pipelines", options, options.frames), m_Count(options.pipelines) {}
+	virtual void OnCreate() override {
+		const VkCullModeFlags cullModes[] = { VK_CULL_MODE_NONE, VK_CULL_MODE_FRONT_BIT, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_AND_BACK };
+		GraphicsPipelineDesc base = CreatePipelineDesc();
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::future<VkPipeline>> builds;
+		for (uint32_t i = 0; i < m_Count; i++) {
+			GraphicsPipelineDesc desc = base;
+			desc.cullMode = cullModes[i % 4];
+			desc.frontFace = (i / 4) % 2 ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+			desc.blendEnable = (i / 8) % 2 == 1;
+			desc.topology = (i / 16) % 2 ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			builds.push_back(GetPipelineBuilder().Build(std::move(desc)));
+		}
+		for (auto& build : builds) {
+			m_Pipelines.push_back(build.get());
+		}
+		std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+		m_Extra.push_back({ "build_ms", buildTime.count() });
+
+		// A layout made per pipeline the way hand written setup does it, against asking the cache with every pipeline's reflected stages
+		std::vector<VkPipelineLayout> layouts(m_Count);
+		VkPipelineLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		start = std::chrono::steady_clock::now();
+		for (VkPipelineLayout& layout : layouts) {
+			vkCreatePipelineLayout(GetDevice(), &layoutInfo, nullptr, &layout);
+		}
+		std::chrono::duration<double, std::milli> createTime = std::chrono::steady_clock::now() - start;
+		for (VkPipelineLayout layout : layouts) {
+			vkDestroyPipelineLayout(GetDevice(), layout, nullptr);
+		}
+		std::vector<const ShaderReflection*> stages = { GetShaderLibrary().GetReflection(base.vertexModule), GetShaderLibrary().GetReflection(base.fragmentModule) };
+		start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < m_Count; i++) {
+			GetLayoutCache().GetPipelineLayout(stages);
+		}
+		std::chrono::duration<double, std::milli> cacheTime = std::chrono::steady_clock::now() - start;
+		m_Extra.push_back({ "layout_create_ms", createTime.count() });
+		m_Extra.push_back({ "layout_cache_ms", cacheTime.count() });
+		m_Extra.push_back({ "layouts_created", static_cast<double>(GetLayoutCache().GetStats().pipelineLayouts) });
+	}
+	virtual void OnRender() override {
+		VkCommandBuffer commandBuffer = GetCommandBuffer();
+		SetViewport(commandBuffer);
+		for (VkPipeline pipeline : m_Pipelines) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+	}
+	virtual void OnDestroy() override {
+		for (VkPipeline pipeline : m_Pipelines) {
+			vkDestroyPipeline(GetDevice(), pipeline, nullptr);
+		}
+	}
+private:
+	uint32_t m_Count;
+	std::vector<VkPipeline> m_Pipelines;
+};
+
+class UploadBenchmark : public BenchmarkApp {
+public:
+	UploadBenchmark(const BenchmarkOptions& options) : BenchmarkApp("Upload", options, options.frames), m_Size(static_cast<VkDeviceSize>(options.uploadMegabytes) * 1024 * 1024) {}
+	virtual void OnCreate() override {
+		m_Data.resize(static_cast<size_t>(m_Size));
+		for (size_t i = 0; i < m_Data.size(); i++) {
+			m_Data[i] = static_cast<char>(i);
+		}
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = m_Size;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		GetAllocator().CreateBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Buffer, m_Memory);
+		m_Extra.push_back({ "upload_mb_per_s", 0 });
+	}
+	virtual void OnUpdate(float dt) override {
+		if (m_Buffer != nullptr) {
+			GetUploadEngine().UploadBuffer(m_Buffer, 0, m_Data.data(), m_Size);
+		}
+	}
+	virtual void OnDestroy() override {
+		// Frame timing stops at device idle, by which point every upload but the unflushed last one has landed
+		GetUploadEngine().Wait(GetUploadEngine().Flush());
+		const FrameStats& stats = GetFrameStats();
+		double megabytes = static_cast<double>(m_Size) / (1024 * 1024);
+		m_Extra.back().second = stats.seconds > 0 ? megabytes * stats.frames / stats.seconds : 0;
+		GetAllocator().DestroyBuffer(m_Buffer, m_Memory);
+	}
+private:
+	VkDeviceSize m_Size;
+	std::vector<char> m_Data;
+	VkBuffer m_Buffer = nullptr;
+	Allocation m_Memory;
+};
+
+// Integrates one particle per draw each update and draws the ones in view, so update and render cost grow together
+class UpdateBenchmark : public BenchmarkApp {
+public:
+	UpdateBenchmark(const BenchmarkOptions& options, bool pipelined) : BenchmarkApp("Update", options, options.frames), m_Draws(options.draws) {
+		PipelinedUpdate = pipelined;
+	}
+	virtual void OnCreate() override {
+		m_Pipeline = GetPipelineBuilder().Build(CreatePipelineDesc()).get();
+		for (auto& positions : m_Positions) {
+			positions.resize(m_Draws);
+			for (uint32_t i = 0; i < m_Draws; i++) {
+				positions[i] = static_cast<float>(i) / m_Draws * 2.0f;
+			}
+		}
+	}
+	virtual void OnUpdate(float dt) override {
+		const std::vector<float>& previous = m_Positions[(GetUpdateSnapshot() + SNAPSHOT_COUNT - 1) % SNAPSHOT_COUNT];
+		std::vector<float>& positions = m_Positions[GetUpdateSnapshot()];
+		for (uint32_t i = 0; i < m_Draws; i++) {
+			// A few dependent square roots stand in for the per object work of a real simulation
+			float speed = 0.1f + static_cast<float>(i % 7) * 0.01f;
+			for (int step = 0; step < 8; step++) {
+				speed = std::sqrt(speed * speed + 0.001f);
+			}
+			float position = previous[i] + speed * dt;
+			positions[i] = position >= 2.0f ? position - 2.0f : position;
+		}
+	}
+	virtual void OnRender() override {
+		const std::vector<float>& positions = m_Positions[GetRenderSnapshot()];
+		VkCommandBuffer commandBuffer = GetCommandBuffer();
+		SetViewport(commandBuffer);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+		for (float position : positions) {
+			if (position < 1.0f) {
+				vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+			}
+		}
+	}
+	virtual void OnDestroy() override {
+		vkDestroyPipeline(GetDevice(), m_Pipeline, nullptr);
+	}
+private:
+	uint32_t m_Draws;
+	std::vector<float> m_Positions[SNAPSHOT_COUNT];
+	VkPipeline m_Pipeline = nullptr;
+};
+
+// Every draw reads its own material from a storage buffer, either through a descriptor set written and bound per draw
+// or through an index into the bindless heap pushed as a constant
+class DescriptorBenchmark : public BenchmarkApp {
+public:
+	DescriptorBenchmark(const BenchmarkOptions& options, bool bindless) : BenchmarkApp("Descriptors", options, options.frames), m_Draws(options.draws), m_Bindless(bindless) {
+		// The per draw sets do not need the heap, leaving it out keeps its setup out of the comparison
+		if (!bindless) {
+			BindlessImages = 0;
+			BindlessBuffers = 0;
+		}
+	}
+	virtual void OnCreate() override {
+		std::vector<float> colors(MATERIALS * STRIDE / sizeof(float));
+		for (uint32_t i = 0; i < MATERIALS; i++) {
+			float* color = &colors[i * STRIDE / sizeof(float)];
+			color[0] = static_cast<float>(i) / MATERIALS;
+			color[1] = color[2] = color[3] = 1.0f;
+		}
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = colors.size() * sizeof(float);
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		GetAllocator().CreateBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Buffer, m_Memory);
+		GetUploadEngine().UploadBuffer(m_Buffer, 0, colors.data(), bufferInfo.size);
+		GetUploadEngine().Flush();
+
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		GraphicsPipelineDesc desc = CreatePipelineDesc(m_Bindless ? "shaders/bench_bindless.frag.spv" : "shaders/bench_sets.frag.spv");
+		desc.layout = GetLayoutCache().GetPipelineLayout({ GetShaderLibrary().GetReflection(desc.vertexModule), GetShaderLibrary().GetReflection(desc.fragmentModule) }, &setLayouts);
+		if (desc.layout == nullptr || (m_Bindless && !GetBindless().IsReady())) {
+			SDL_LogError(0, "Descriptor benchmark has no layout, the device may lack descriptor indexing");
+			Close();
+			return;
+		}
+		m_Layout = desc.layout;
+		m_SetLayout = setLayouts.at(0);
+		m_Pipeline = GetPipelineBuilder().Build(std::move(desc)).get();
+		if (m_Bindless) {
+			for (uint32_t i = 0; i < MATERIALS; i++) {
+				m_Materials.push_back(GetBindless().AddBuffer(m_Buffer, i * STRIDE, 4 * sizeof(float)));
+			}
+		}
+	}
+	virtual void OnRender() override {
+		if (m_Pipeline == nullptr) {
+			return;
+		}
+		VkCommandBuffer commandBuffer = GetCommandBuffer();
+		SetViewport(commandBuffer);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+		if (m_Bindless) {
+			// One bind for the whole frame, a draw only changes the four bytes of its index
+			GetBindless().Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Layout);
+			for (uint32_t i = 0; i < m_Draws; i++) {
+				vkCmdPushConstants(commandBuffer, m_Layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &m_Materials[i % MATERIALS]);
+				vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+			}
+			return;
+		}
+		VkDescriptorPool pool = AcquirePool();
+		for (uint32_t i = 0; i < m_Draws; i++) {
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = pool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &m_SetLayout;
+			VkDescriptorSet set = nullptr;
+			vkAllocateDescriptorSets(GetDevice(), &allocInfo, &set);
+			VkDescriptorBufferInfo bufferInfo{ m_Buffer, (i % MATERIALS) * STRIDE, 4 * sizeof(float) };
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = 0;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			write.pBufferInfo = &bufferInfo;
+			vkUpdateDescriptorSets(GetDevice(), 1, &write, 0, nullptr);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Layout, 0, 1, &set, 0, nullptr);
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+		m_Pools.push_back({ GetGraphicsTimeline().GetPendingValue(), pool });
+	}
+	virtual void OnDestroy() override {
+		for (uint32_t index : m_Materials) {
+			GetBindless().ReleaseBuffer(index);
+		}
+		for (auto& [value, pool] : m_Pools) {
+			vkDestroyDescriptorPool(GetDevice(), pool, nullptr);
+		}
+		vkDestroyPipeline(GetDevice(), m_Pipeline, nullptr);
+		GetAllocator().DestroyBuffer(m_Buffer, m_Memory);
+	}
+private:
+	static constexpr uint32_t MATERIALS = 256;
+	// Covers every device's minStorageBufferOffsetAlignment
+	static constexpr VkDeviceSize STRIDE = 256;
+	uint32_t m_Draws;
+	bool m_Bindless;
+	VkBuffer m_Buffer = nullptr;
+	Allocation m_Memory;
+	VkPipelineLayout m_Layout = nullptr;
+	VkDescriptorSetLayout m_SetLayout = nullptr;
+	VkPipeline m_Pipeline = nullptr;
+	std::vector<uint32_t> m_Materials;
+	// One pool per recorded frame, reset once the frame that used it has completed
+	std::deque<std::pair<uint64_t, VkDescriptorPool>> m_Pools;
+	VkDescriptorPool AcquirePool() {
+		if (!m_Pools.empty() && GetGraphicsTimeline().IsComplete(m_Pools.front().first)) {
+			VkDescriptorPool pool = m_Pools.front().second;
+			m_Pools.pop_front();
+			vkResetDescriptorPool(GetDevice(), pool, 0);
+			return pool;
+		}
+		VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_Draws };
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = m_Draws;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+		VkDescriptorPool pool = nullptr;
+		vkCreateDescriptorPool(GetDevice(), &poolInfo, nullptr, &pool);
+		return pool;
+	}
+};
+
+// Loads a directory of shaders where every file has a few duplicates, the way permutations and copies pile up in real projects
+class ShaderLoadBenchmark : public BenchmarkApp {
+public:
+	ShaderLoadBenchmark(const BenchmarkOptions& options) : BenchmarkApp("Shaders", options, 1), m_Count(options.shaders) {}
+	// Frame statistics mean nothing for the single frame this runs
+	const BenchmarkResult& GetLoadResult() const {
+		return m_Extra;
+	}
+	virtual void OnCreate() override {
+		std::vector<std::string> paths = WriteVariants();
+		if (paths.empty()) {
+			return;
+		}
+		// Reading into a vector and creating a module per file, the way shaders were loaded before the library
+		auto start = std::chrono::steady_clock::now();
+		std::vector<VkShaderModule> modules;
+		for (const std::string& path : paths) {
+			std::vector<uint32_t> code = ReadShader(path);
+			VkShaderModuleCreateInfo moduleInfo{};
+			moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			moduleInfo.codeSize = code.size() * sizeof(uint32_t);
+			moduleInfo.pCode = code.data();
+			VkShaderModule module = nullptr;
+			vkCreateShaderModule(GetDevice(), &moduleInfo, nullptr, &module);
+			modules.push_back(module);
+		}
+		std::chrono::duration<double, std::milli> readTime = std::chrono::steady_clock::now() - start;
+		for (VkShaderModule module : modules) {
+			vkDestroyShaderModule(GetDevice(), module, nullptr);
+		}
+
+		ShaderLibrary::Stats before = GetShaderLibrary().GetStats();
+		start = std::chrono::steady_clock::now();
+		for (const std::string& path : paths) {
+			GetShaderLibrary().Load(path.c_str());
+		}
+		std::chrono::duration<double, std::milli> libraryTime = std::chrono::steady_clock::now() - start;
+		ShaderLibrary::Stats after = GetShaderLibrary().GetStats();
+
+		// The same shaders packed into one archive, loaded by a library of their own so it has to create every module again
+		std::string archivePath = std::string(VARIANT_DIRECTORY) + "/variants.pak";
+		if (!AssetArchive::Write(archivePath.c_str(), paths)) {
+			SDL_LogError(0, "Failed to write %s", archivePath.c_str());
+		}
+		ShaderLibrary packed;
+		packed.Init(GetDevice());
+		start = std::chrono::steady_clock::now();
+		AssetArchive archive;
+		if (archive.Open(archivePath.c_str())) {
+			packed.SetArchive(&archive);
+		}
+		for (const std::string& path : paths) {
+			packed.Load(path.c_str());
+		}
+		std::chrono::duration<double, std::milli> archiveTime = std::chrono::steady_clock::now() - start;
+		packed.Shutdown();
+		archive.Close();
+		std::filesystem::remove_all(VARIANT_DIRECTORY);
+
+		m_Extra.push_back({ "read_ms", readTime.count() });
+		m_Extra.push_back({ "library_ms", libraryTime.count() });
+		m_Extra.push_back({ "archive_ms", archiveTime.count() });
+		m_Extra.push_back({ "modules_created", static_cast<double>(after.modules - before.modules) });
+		m_Extra.push_back({ "speedup_ratio", libraryTime.count() > 0 ? readTime.count() / libraryTime.count() : 0 });
+		m_Extra.push_back({ "archive_speedup_ratio", archiveTime.count() > 0 ? libraryTime.count() / archiveTime.count() : 0 });
+	}
+private:
+	static constexpr const char* VARIANT_DIRECTORY = "shaders/variants";
+	uint32_t m_Count;
+	// Every fourth file is unique, the SPIR-V generator word is free to change without touching what the shader does.
+	// Writing them leaves every file in the page cache, so both loaders start warm.
+	std::vector<std::string> WriteVariants() const {
+		std::vector<uint32_t> sources[] = { ReadShader("shaders/bench.vert.spv"), ReadShader("shaders/bench.frag.spv") };
+		if (sources[0].size() < 5 || sources[1].size() < 5) {
+			return {};
+		}
+		std::filesystem::create_directories(VARIANT_DIRECTORY);
+		std::vector<std::string> paths;
+		for (uint32_t i = 0; i < m_Count; i++) {
+			std::vector<uint32_t> code = sources[i % 2];
+			code[2] = i / 8;
+			paths.push_back(std::string(VARIANT_DIRECTORY) + "/" + std::to_string(i) + ".spv");
+			std::ofstream file(paths.back(), std::ios::binary);
+			file.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(uint32_t));
+		}
+		return paths;
+	}
+};
+
+BenchmarkResult RunEmptyFrameBenchmark(const BenchmarkOptions& options) {
+	BenchmarkApp app("Empty", options, options.frames);
+	app.Run();
+	return app.GetResult();
+}
+
+BenchmarkResult RunDrawBenchmark(const BenchmarkOptions& options) {
+	DrawBenchmark app(options);
+	app.Run();
+	return app.GetResult();
+}
+
+BenchmarkResult RunParallelDrawBenchmark(const BenchmarkOptions& options) {
+	DrawBenchmark app(options, true);
+	app.Run();
+	return app.GetResult();
+}
+
+BenchmarkResult RunPipelineBenchmark(const BenchmarkOptions& options) {
+	PipelineBenchmark app(options);
+	app.Run();
+	return app.GetResult();
+}
+
+BenchmarkResult RunUploadBenchmark(const BenchmarkOptions& options) {
+	UploadBenchmark app(options);
+	app.Run();
+	return app.GetResult();
+}
+
+// A single frame, so the startup time includes everything up to the first submit
+BenchmarkResult RunStartupBenchmark(const BenchmarkOptions& options) {
+	BenchmarkApp app("Startup", options, 1);
+	app.Run();
+	const FrameStats& stats = app.GetFrameStats();
+	return { { "startup_ms", stats.startupMs } };
+}
+
+BenchmarkResult RunFramesInFlightBenchmark(const BenchmarkOptions& options) {
+	BenchmarkResult result;
+	for (uint32_t depth = 1; depth <= 4; depth++) {
+		BenchmarkOptions depthOptions = options;
+		depthOptions.framesInFlight = depth;
+		DrawBenchmark app(depthOptions);
+		app.Run();
+		const FrameStats& stats = app.GetFrameStats();
+		std::string prefix = "depth" + std::to_string(depth);
+		result.push_back({ prefix + "_fps", stats.seconds > 0 ? stats.frames / stats.seconds : 0 });
+		result.push_back({ prefix + "_gpu_wait_ms", stats.gpuWaitMs });
+	}
+	return result;
+}
+
+BenchmarkResult RunPipelinedUpdateBenchmark(const BenchmarkOptions& options) {
+	BenchmarkResult result;
+	for (bool pipelined : { false, true }) {
+		UpdateBenchmark app(options, pipelined);
+		app.Run();
+		const FrameStats& stats = app.GetFrameStats();
+		std::string prefix = pipelined ? "pipelined" : "serial";
+		result.push_back({ prefix + "_fps", stats.seconds > 0 ? stats.frames / stats.seconds : 0 });
+		result.push_back({ prefix + "_cpu_avg_ms", stats.cpuAvgMs });
+		result.push_back({ prefix + "_latency_avg_ms", stats.latencyAvgMs });
+	}
+	return result;
+}
+
+BenchmarkResult RunShaderLoadBenchmark(const BenchmarkOptions& options) {
+	ShaderLoadBenchmark app(options);
+	app.Run();
+	return app.GetLoadResult();
+}
+
+BenchmarkResult RunDescriptorBenchmark(const BenchmarkOptions& options) {
+	BenchmarkResult result;
+	double cpuMs[2] = {};
+	for (bool bindless : { false, true }) {
+		DescriptorBenchmark app(options, bindless);
+		app.Run();
+		const FrameStats& stats = app.GetFrameStats();
+		std::string prefix = bindless ? "bindless" : "sets";
+		cpuMs[bindless] = stats.cpuAvgMs;
+		result.push_back({ prefix + "_fps", stats.seconds > 0 ? stats.frames / stats.seconds : 0 });
+		result.push_back({ prefix + "_cpu_avg_ms", stats.cpuAvgMs });
+	}
+	result.push_back({ "bindless_speedup_ratio", cpuMs[1] > 0 ? cpuMs[0] / cpuMs[1] : 0 });
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <Benchmarks.h>
+#include <JobSystem.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+// Compares the job system against launching a std::async task per chunk, on the CPU only
+BenchmarkResult RunJobBenchmark(const BenchmarkOptions& options) {
+	constexpr uint32_t ITEMS = 1 << 20;
+	constexpr uint32_t GRAIN = 1024;
+	constexpr uint32_t REPEATS = 20;
+	constexpr uint32_t EMPTY_JOBS = 100000;
+
+	JobSystem jobs;
+	jobs.Init();
+	std::vector<float> values(ITEMS);
+	// A few hundred nanoseconds per item, roughly a culling or animation step
+	auto work = [&values](uint32_t first, uint32_t last) {
+		for (uint32_t i = first; i < last; i++) {
+			float x = static_cast<float>(i);
+			for (int step = 0; step < 16; step++) {
+				x = std::sqrt(x * x + 1.0f) * 0.5f;
+			}
+			values[i] = x;
+		}
+	};
+	auto seconds = [](auto start) {
+		return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t repeat = 0; repeat < REPEATS; repeat++) {
+		jobs.ParallelFor(ITEMS, GRAIN, work);
+	}
+	double jobSeconds = seconds(start) / REPEATS;
+
+	start = std::chrono::high_resolution_clock::now();
+	std::vector<std::future<void>> futures;
+	futures.reserve(ITEMS / GRAIN);
+	for (uint32_t repeat = 0; repeat < REPEATS; repeat++) {
+		for (uint32_t first = 0; first < ITEMS; first += GRAIN) {
+			futures.push_back(std::async(std::launch::async, work, first, first + GRAIN));
+		}
+		for (auto& future : futures) {
+			future.get();
+		}
+		futures.clear();
+	}
+	double asyncSeconds = seconds(start) / REPEATS;
+
+	// Cost of dispatching work too small to matter, where scheduling overhead is all that is measured
+	start = std::chrono::high_resolution_clock::now();
+	JobCounter counter;
+	for (uint32_t i = 0; i < EMPTY_JOBS; i++) {
+		jobs.Run([]() {}, &counter);
+	}
+	jobs.Wait(counter);
+	double jobDispatchSeconds = seconds(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	// Every std::async task is a thread, so they are launched in waves to stay under the process thread limit
+	for (uint32_t first = 0; first < EMPTY_JOBS; first += ITEMS / GRAIN) {
+		for (uint32_t i = first; i < first + ITEMS / GRAIN && i < EMPTY_JOBS; i++) {
+			futures.push_back(std::async(std::launch::async, []() {}));
+		}
+		for (auto& future : futures) {
+			future.get();
+		}
+		futures.clear();
+	}
+	double asyncDispatchSeconds = seconds(start);
+
+	jobs.Shutdown();
+	return {
+		{ "job_system_ms", jobSeconds * 1000.0 },
+		{ "async_ms", asyncSeconds * 1000.0 },
+		{ "speedup_ratio", asyncSeconds / jobSeconds },
+		{ "job_dispatch_ns", jobDispatchSeconds * 1e9 / EMPTY_JOBS },
+		{ "async_dispatch_ns", asyncDispatchSeconds * 1e9 / EMPTY_JOBS }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include <Benchmarks.h>
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+
+struct Scenario {
+	const char* name;
+	std::function<BenchmarkResult(const BenchmarkOptions&)> run;
+};
+
+static const Scenario scenarios[] = {
+	{ "allocator", RunAllocatorBenchmark },
+	{ "jobs", RunJobBenchmark },
+	{ "empty_frame", RunEmptyFrameBenchmark },
+	{ "draws", RunDrawBenchmark },
+	{ "parallel_draws", RunParallelDrawBenchmark },
+	{ "pipelines", RunPipelineBenchmark },
+	{ "upload", RunUploadBenchmark },
+	{ "startup", RunStartupBenchmark },
+	{ "shaders", RunShaderLoadBenchmark },
+	{ "frames_in_flight", RunFramesInFlightBenchmark },
+	{ "pipelined_update", RunPipelinedUpdateBenchmark },
+	{ "bindless", RunDescriptorBenchmark }
+};
+
+using Results = std::map<std::string, BenchmarkResult>;
+
+static bool HigherIsBetter(const std::string& name) {
+	auto endsWith = [&name](const char* suffix) {
+		size_t length = strlen(suffix);
+		return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+	};
+	return endsWith("fps") || endsWith("_per_s") || endsWith("_ratio");
+}
+
+static std::string ToJson(const std::vector<std::pair<std::string, BenchmarkResult>>& results) {
+	std::ostringstream json;
+	json << "{\n";
+	char number[32];
+	for (size_t i = 0; i < results.size(); i++) {
+		json << "\t\"" << results[i].first << "\": {";
+		const BenchmarkResult& result = results[i].second;
+		for (size_t j = 0; j < result.size(); j++) {
+			snprintf(number, sizeof(number), "%.6g", result[j].second);
+			json << (j == 0 ? " \"" : ", \"") << result[j].first << "\": " << number;
+		}
+		json << (i + 1 < results.size() ? " },\n" : " }\n");
+	}
+	json << "}\n";
+	return json.str();
+}
+
+// Reads back the two level object written by ToJson, anything else is rejected
+static bool ParseBaseline(const char* path, Results& results) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		fprintf(stderr, "Failed to open baseline %s\n", path);
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	std::string text = buffer.str();
+	size_t pos = 0;
+	auto skip = [&]() {
+		while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) pos++;
+	};
+	auto expect = [&](char c) {
+		skip();
+		if (pos < text.size() && text[pos] == c) {
+			pos++;
+			return true;
+		}
+		return false;
+	};
+	auto readString = [&](std::string& out) {
+		if (!expect('"')) return false;
+		size_t end = text.find('"', pos);
+		if (end == std::string::npos) return false;
+		out = text.substr(pos, end - pos);
+		pos = end + 1;
+		return true;
+	};
+	if (!expect('{')) return false;
+	if (expect('}')) return true;
+	do {
+		std::string scenario;
+		if (!readString(scenario) || !expect(':') || !expect('{')) return false;
+		BenchmarkResult& result = results[scenario];
+		if (!expect('}')) {
+			do {
+				std::string name;
+				if (!readString(name) || !expect(':')) return false;
+				skip();
+				char* end = nullptr;
+				double value = strtod(text.c_str() + pos, &end);
+				if (end == text.c_str() + pos) return false;
+				pos = end - text.c_str();
+				result.push_back({ name, value });
+			} while (expect(','));
+			if (!expect('}')) return false;
+		}
+	} while (expect(','));
+	return expect('}');
+}
+
+// Prints every metric that moved past the threshold in the wrong direction and returns how many did
+static int CompareToBaseline(const std::vector<std::pair<std::string, BenchmarkResult>>& results, const Results& baseline, double threshold) {
+	int regressions = 0;
+	for (const auto& scenario : results) {
+		auto found = baseline.find(scenario.first);
+		if (found == baseline.end()) {
+			continue;
+		}
+		for (const auto& metric : scenario.second) {
+			for (const auto& reference : found->second) {
+				if (reference.first != metric.first) {
+					continue;
+				}
+				// There is no relative change from zero, so any growth of a zero cost such as a failure count is a regression
+				if (reference.second == 0) {
+					if (!HigherIsBetter(metric.first) && metric.second > 0) {
+						fprintf(stderr, "REGRESSION %s.%s: 0 -> %.6g\n", scenario.first.c_str(), metric.first.c_str(), metric.second);
+						regressions++;
+					}
+					continue;
+				}
+				double change = (metric.second - reference.second) / std::fabs(reference.second);
+				bool regressed = HigherIsBetter(metric.first) ? change < -threshold : change > threshold;
+				if (regressed) {
+					fprintf(stderr, "REGRESSION %s.%s: %.6g -> %.6g (%+.1f%%)\n", scenario.first.c_str(), metric.first.c_str(), reference.second, metric.second, change * 100.0);
+					regressions++;
+				}
+			}
+		}
+	}
+	return regressions;
+}
+
+int main(int argc, char* argv[]) {
+	// Runs every scenario, or only the ones named on the command line
+	BenchmarkOptions options;
+	const char* outputPath = nullptr;
+	const char* baselinePath = nullptr;
+	double threshold = 0.1;
+	std::vector<const char*> selection;
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+			options.frames = strtoull(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--draws") == 0 && hasValue) {
+			options.draws = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--pipelines") == 0 && hasValue) {
+			options.pipelines = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--upload-mb") == 0 && hasValue) {
+			options.uploadMegabytes = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--shaders") == 0 && hasValue) {
+			options.shaders = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--frames-in-flight") == 0 && hasValue) {
+			options.framesInFlight = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+			outputPath = argv[++i];
+		} else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+			baselinePath = argv[++i];
+		} else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+			threshold = strtod(argv[++i], nullptr);
+		} else {
+			selection.push_back(argv[i]);
+		}
+	}
+	// A typo would otherwise run nothing and pass any baseline comparison
+	for (const char* name : selection) {
+		bool known = false;
+		for (const Scenario& scenario : scenarios) {
+			known |= strcmp(name, scenario.name) == 0;
+		}
+		if (!known) {
+			fprintf(stderr, "Unknown scenario or option %s\n", name);
+			return EXIT_FAILURE;
+		}
+	}
+	std::vector<std::pair<std::string, BenchmarkResult>> results;
+	for (const Scenario& scenario : scenarios) {
+		bool selected = selection.empty();
+		for (const char* name : selection) {
+			selected |= strcmp(name, scenario.name) == 0;
+		}
+		if (selected) {
+			fprintf(stderr, "Running %s\n", scenario.name);
+			results.push_back({ scenario.name, scenario.run(options) });
+		}
+	}
+	std::string json = ToJson(results);
+	printf("%s", json.c_str());
+	if (outputPath != nullptr) {
+		std::ofstream file(outputPath);
+		file << json;
+	}
+	if (baselinePath != nullptr) {
+		Results baseline;
+		if (!ParseBaseline(baselinePath, baseline)) {
+			fprintf(stderr, "Baseline %s is not a benchmark result file\n", baselinePath);
+			return EXIT_FAILURE;
+		}
+		int regressions = CompareToBaseline(results, baseline, threshold);
+		if (regressions > 0) {
+			fprintf(stderr, "%d metric(s) regressed by more than %.0f%%\n", regressions, threshold * 100.0);
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -4,10 +4,13 @@ project "HelloTriangle"
 	cppdialect "C++17"
 	targetdir "../bin/%{prj.name}/%{cfg.buildcfg}"
 	objdir "../obj/%{prj.name}/%{cfg.buildcfg}"
-	files {"**.cpp", "**.vert", "**.frag"}
+	dependson "AssetPacker"
+	-- Only for the header describing the asset archive format
+	includedirs "../AppFramework/include"
+	files {"**.cpp", "**.vert", "**.frag", "**.comp"}
 	vpaths {
 		["Source"] = "**.cpp",
-		["Resource"] = {"**.vert", "**.frag"}
+		["Resource"] = {"**.vert", "**.frag", "**.comp"}
 	}
 
 	-- Prebuild commands to compile shaders and move them into the correct directory
@@ -17,7 +20,18 @@ project "HelloTriangle"
 		"{MOVE} vert.spv shaders/vert.spv",
 		"glslc res/shader.frag -o frag.spv",
 		"{MOVE} frag.spv shaders/frag.spv",
-		"{COPYFILE} shaders ../bin/%{prj.name}/%{cfg.buildcfg}/shaders"
+		"glslc res/gpu_driven.vert -o gpu_driven.vert.spv",
+		"{MOVE} gpu_driven.vert.spv shaders/gpu_driven.vert.spv",
+		"glslc res/cull.comp -o cull.comp.spv",
+		"{MOVE} cull.comp.spv shaders/cull.comp.spv",
+		"glslc res/instanced.vert -o instanced.vert.spv",
+		"{MOVE} instanced.vert.spv shaders/instanced.vert.spv",
+		"glslc res/animate.comp -o animate.comp.spv",
+		"{MOVE} animate.comp.spv shaders/animate.comp.spv",
+		"{COPYFILE} shaders ../bin/%{prj.name}/%{cfg.buildcfg}/shaders",
+		-- Packs the compiled shaders under the same names, loaded instead of the loose files when present
+		"\"../bin/AssetPacker/%{cfg.buildcfg}/AssetPacker\" assets.pak shaders",
+		"{COPYFILE} assets.pak ../bin/%{prj.name}/%{cfg.buildcfg}/assets.pak"
 	}
 
 	filter "system:windows"
@@ -26,6 +40,9 @@ project "HelloTriangle"
 		links {"vulkan-1.lib", "SDL2.lib"}
 		defines "SDL_MAIN_HANDLED"
 
+	filter "system:linux"
+		links {"vulkan", "SDL2", "pthread"}
+
 	filter "configurations:Debug"
 		defines "DEBUG"
 		symbols "On"
@@ -0,0 +1,29 @@
+#version 450
+
+layout (location = 0) in vec2 inPosition;
+layout (location = 1) in vec3 inColor;
+
+layout (location = 0) out vec3 fragColor;
+
+struct Object {
+	vec2 position;
+	float scale;
+	float radius;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects {
+	Object objects[];
+};
+
+layout(set = 0, binding = 3) uniform Frame {
+	vec2 camera;
+	uint objectCount;
+	uint indexCount;
+};
+
+void main() {
+	// The culling pass stores the object index as the draw's first instance
+	Object object = objects[gl_InstanceIndex];
+	gl_Position = vec4(inPosition * object.scale + object.position - camera, 0.0, 1.0);
+	fragColor = inColor;
+}
\ No newline at end of file
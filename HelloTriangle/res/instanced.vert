@@ -0,0 +1,17 @@
+#version 450
+
+layout (location = 0) in vec2 inPosition;
+layout (location = 1) in vec3 inColor;
+layout (location = 2) in vec2 instancePosition;
+layout (location = 3) in vec4 instanceColor;
+
+layout (location = 0) out vec3 fragColor;
+
+layout(push_constant) uniform Instances {
+	float scale;
+};
+
+void main() {
+	gl_Position = vec4(inPosition * scale + instancePosition, 0.0, 1.0);
+	fragColor = inColor * instanceColor.rgb;
+}
\ No newline at end of file
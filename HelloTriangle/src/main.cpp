@@ -2,6 +2,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
 #include <vulkan/vulkan.hpp>
+#include <AssetFormat.h>
 
 #include <iostream>
 #include <vector>
@@ -12,12 +13,41 @@
 #include <limits>
 #include <algorithm>
 #include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <xmmintrin.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 #ifdef DEBUG
 #define ENABLE_VALIDATION_LAYERS
 #endif
 
-constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+constexpr size_t MAX_FRAMES_IN_FLIGHT = 4;
 
 static VkResult CreateDebugUtilsMessengerEXT(
 	VkInstance instance,
@@ -58,8 +88,132 @@ struct SwapChainSupportDetails {
 	std::vector<VkPresentModeKHR> presentModes{};
 };
 
+// Interleaved so each vertex is fetched from a single binding
+struct Vertex {
+	glm::vec2 pos;
+	glm::vec3 color;
+	static VkVertexInputBindingDescription getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(Vertex);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescription;
+	}
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(Vertex, pos);
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(Vertex, color);
+		return attributeDescriptions;
+	}
+};
+
+// A whole file mapped read only, the pages are page aligned so SPIR-V can be handed to the driver without copying into a buffer first
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& filename) {
+#ifdef _WIN32
+		file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		LARGE_INTEGER fileSize{};
+		if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			close();
+			throw std::runtime_error("failed to open file '" + filename + "'");
+		}
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		data = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int file = open(filename.c_str(), O_RDONLY);
+		struct stat status {};
+		if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0) {
+			if (file >= 0) {
+				::close(file);
+			}
+			throw std::runtime_error("failed to open file '" + filename + "'");
+		}
+		size = static_cast<size_t>(status.st_size);
+		data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file); // The mapping holds its own reference
+		if (data == MAP_FAILED) {
+			data = nullptr;
+		}
+#endif
+		if (data == nullptr) {
+			close();
+			throw std::runtime_error("failed to map file '" + filename + "'");
+		}
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() {
+		close();
+	}
+	const void* getData() const {
+		return data;
+	}
+	size_t getSize() const {
+		return size;
+	}
+private:
+	void* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+	void close() {
+#ifdef _WIN32
+		if (data != nullptr) {
+			UnmapViewOfFile(data);
+		}
+		if (mapping != nullptr) {
+			CloseHandle(mapping);
+		}
+		if (file != INVALID_HANDLE_VALUE) {
+			CloseHandle(file);
+		}
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data != nullptr) {
+			munmap(data, size);
+		}
+#endif
+		data = nullptr;
+	}
+};
+
+struct HelloTriangleOptions {
+	bool headless = false; // Render into offscreen images for a fixed number of frames instead of presenting to a window
+	size_t frameCount = 10000; // Frames rendered before exiting when headless
+	bool readback = false; // Copy every headless frame back to host memory
+	std::string dumpPath{}; // Where the last read back frame is written as a PPM image
+	std::string pipelineCachePath = "pipeline_cache.bin"; // Compiled pipelines are kept here between runs
+	std::string assetArchivePath = "assets.pak"; // Shaders packed at build time, the loose files are used when it is missing
+	size_t stressTriangles = 0; // Draws a grid of this many triangles instead of one to measure vertex throughput
+	size_t framesInFlight = 2; // Frames the CPU may record ahead of the GPU, between 1 and MAX_FRAMES_IN_FLIGHT
+	bool staticCommands = false; // Reuse pre-recorded command buffers, re-recording only when what they captured changes
+	size_t gpuDrivenObjects = 0; // Culls and draws this many copies of the mesh on the GPU through indirect draws
+	size_t instanceCount = 0; // Draws this many animated copies of the mesh with a single instanced draw
+	bool gpuAnimation = false; // Animates the instances with a compute shader instead of SSE on the CPU
+	std::string hotReloadDirectory{}; // Watches the shader sources in here, recompiling changed ones and swapping in their pipelines while running
+};
+
 class HelloTriangle {
 public:
+	HelloTriangle(const HelloTriangleOptions& options) : options(options) {}
+	~HelloTriangle() {
+		// Only still running when an exception skipped cleanUp
+		if (shaderWatcher.joinable()) {
+			watchingShaders = false;
+			shaderWatcher.join();
+		}
+	}
 	void run() {
 		init();
 		mainLoop();
@@ -72,10 +226,12 @@ private: // Private functions
 	}
 	void mainLoop() {
 		running = true;
+		size_t frameCount = 0;
+		Uint64 start = SDL_GetPerformanceCounter();
 		while (running) {
 			// Polling events
 			SDL_Event event;
-			while (SDL_PollEvent(&event)) {
+			while (!options.headless && SDL_PollEvent(&event)) {
 				switch (event.type) {
 				case SDL_QUIT:
 					running = false;
@@ -85,32 +241,148 @@ private: // Private functions
 						running = false;
 					}
 					break;
+				case SDL_WINDOWEVENT:
+					if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+						framebufferResized = true;
+					}
+					break;
 				}
 			}
+			// A minimized window has a zero sized surface, so there is nothing to render into
+			if (!options.headless && (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)) {
+				SDL_WaitEvent(nullptr);
+				continue;
+			}
 			// Render Code Here
 			drawFrame();
+			frameCount++;
+			if (options.headless && frameCount >= options.frameCount) {
+				running = false;
+			}
 		}
 		vkDeviceWaitIdle(logicalDevice);
+		if (readbackEnabled()) {
+			// Collecting the frames still in flight, oldest first
+			for (size_t i = 0; i < options.framesInFlight; i++) {
+				collectReadback((currentFrame + i) % options.framesInFlight);
+			}
+			std::cout << "Read back " << readbackFrameCount << " frames" << std::endl;
+		}
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			collectTimestamps(i);
+		}
+		printRenderPassTimes();
+		double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+		std::cout << "Rendered " << frameCount << " frames in " << seconds << "s (" << frameCount / seconds << " fps)" << std::endl;
+		// The less time spent here the more the CPU overlaps with the GPU
+		double fenceWaitMs = static_cast<double>(fenceWaitTicks) / SDL_GetPerformanceFrequency() * 1000.0 / frameCount;
+		std::cout << "Waited " << fenceWaitMs << " ms per frame on the GPU with " << options.framesInFlight << " frames in flight" << std::endl;
+		double recordMs = static_cast<double>(recordTicks) / SDL_GetPerformanceFrequency() * 1000.0 / frameCount;
+		std::cout << "Spent " << recordMs << " ms per frame recording commands, " << recordCount << " command buffers recorded" << (options.staticCommands ? " with static commands" : "") << std::endl;
+		if (instanced()) {
+			double instances = static_cast<double>(options.instanceCount) * frameCount;
+			std::cout << "Instance throughput " << instances / seconds / 1e6 << " M instances/s" << std::endl;
+			if (!options.gpuAnimation) {
+				double animateSeconds = static_cast<double>(animateTicks) / SDL_GetPerformanceFrequency();
+				double bytes = instances * sizeof(glm::vec2);
+				std::cout << "Animated on the CPU in " << animateSeconds * 1000.0 / frameCount << " ms per frame, writing " << bytes / animateSeconds / 1e9 << " GB/s of positions" << std::endl;
+			}
+		}
+		if (options.stressTriangles > 0) {
+			double triangles = static_cast<double>(indices.size() / 3) * frameCount;
+			std::cout << "Vertex throughput " << triangles / seconds / 1e6 << " Mtri/s" << std::endl;
+		}
 	}
 	void cleanUp() {
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		stopShaderWatcher();
+		while (!retiredSwapChains.empty()) {
+			destroySwapChainResources(retiredSwapChains.front());
+			retiredSwapChains.pop_front();
+		}
+		for (size_t i = 0; i < options.framesInFlight; i++) {
 			vkDestroySemaphore(logicalDevice, imageAvailableSemaphores.at(i), nullptr);
-			vkDestroySemaphore(logicalDevice, renderFinishedSemaphores.at(i), nullptr);
 			vkDestroyFence(logicalDevice, inFlightFences.at(i), nullptr);
 		}
+		for (VkSemaphore semaphore : renderFinishedSemaphores) {
+			vkDestroySemaphore(logicalDevice, semaphore, nullptr);
+		}
+		for (size_t i = 0; i < readbackBuffers.size(); i++) {
+			vkUnmapMemory(logicalDevice, readbackMemory.at(i));
+			vkDestroyBuffer(logicalDevice, readbackBuffers.at(i), nullptr);
+			vkFreeMemory(logicalDevice, readbackMemory.at(i), nullptr);
+		}
+		vkDestroyBuffer(logicalDevice, indexBuffer, nullptr);
+		vkFreeMemory(logicalDevice, indexBufferMemory, nullptr);
+		vkDestroyBuffer(logicalDevice, vertexBuffer, nullptr);
+		vkFreeMemory(logicalDevice, vertexBufferMemory, nullptr);
+		for (auto queryPool : timestampQueryPools) {
+			vkDestroyQueryPool(logicalDevice, queryPool, nullptr);
+		}
+		for (size_t i = 0; i < cullUniformBuffers.size(); i++) {
+			vkUnmapMemory(logicalDevice, cullUniformMemory.at(i));
+			vkDestroyBuffer(logicalDevice, cullUniformBuffers.at(i), nullptr);
+			vkFreeMemory(logicalDevice, cullUniformMemory.at(i), nullptr);
+			vkDestroyBuffer(logicalDevice, drawCountBuffers.at(i), nullptr);
+			vkFreeMemory(logicalDevice, drawCountMemory.at(i), nullptr);
+			vkDestroyBuffer(logicalDevice, drawCommandBuffers.at(i), nullptr);
+			vkFreeMemory(logicalDevice, drawCommandMemory.at(i), nullptr);
+		}
+		for (size_t i = 0; i < instancePositionBuffers.size(); i++) {
+			if (instancePositionMapped.at(i) != nullptr) {
+				vkUnmapMemory(logicalDevice, instancePositionMemory.at(i));
+			}
+			vkDestroyBuffer(logicalDevice, instancePositionBuffers.at(i), nullptr);
+			vkFreeMemory(logicalDevice, instancePositionMemory.at(i), nullptr);
+		}
+		for (size_t i = 0; i < animateUniformBuffers.size(); i++) {
+			vkUnmapMemory(logicalDevice, animateUniformMemory.at(i));
+			vkDestroyBuffer(logicalDevice, animateUniformBuffers.at(i), nullptr);
+			vkFreeMemory(logicalDevice, animateUniformMemory.at(i), nullptr);
+		}
+		vkDestroyBuffer(logicalDevice, instanceBaseBuffer, nullptr);
+		vkFreeMemory(logicalDevice, instanceBaseMemory, nullptr);
+		vkDestroyBuffer(logicalDevice, instanceColorBuffer, nullptr);
+		vkFreeMemory(logicalDevice, instanceColorMemory, nullptr);
+		vkDestroyDescriptorPool(logicalDevice, animateDescriptorPool, nullptr);
+		vkDestroyPipeline(logicalDevice, animatePipeline, nullptr);
+		vkDestroyBuffer(logicalDevice, objectBuffer, nullptr);
+		vkFreeMemory(logicalDevice, objectBufferMemory, nullptr);
+		vkDestroyDescriptorPool(logicalDevice, cullDescriptorPool, nullptr);
+		vkDestroyPipeline(logicalDevice, cullPipeline, nullptr);
 		vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
 		vkDestroyPipeline(logicalDevice, graphicsPipeline, nullptr);
+		savePipelineCache();
+		vkDestroyPipelineCache(logicalDevice, pipelineCache, nullptr);
 		vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
+		for (const auto& [hash, cached] : shaderModules) {
+			vkDestroyShaderModule(logicalDevice, cached.shaderModule, nullptr);
+		}
+		vkDestroyDescriptorSetLayout(logicalDevice, cullSetLayout, nullptr);
+		vkDestroyDescriptorSetLayout(logicalDevice, animateSetLayout, nullptr);
+		for (auto framebuffer : swapChainFramebuffers) {
+			vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+		}
 		vkDestroyRenderPass(logicalDevice, renderPass, nullptr);
 		for (auto imageView : swapChainImageViews) {
 			vkDestroyImageView(logicalDevice, imageView, nullptr);
 		}
-		vkDestroySwapchainKHR(logicalDevice, swapChain, nullptr);
+		if (options.headless) {
+			// Offscreen targets are owned by the application rather than a swap chain
+			for (size_t i = 0; i < swapChainImages.size(); i++) {
+				vkDestroyImage(logicalDevice, swapChainImages.at(i), nullptr);
+				vkFreeMemory(logicalDevice, offscreenImageMemory.at(i), nullptr);
+			}
+		}
+		else {
+			vkDestroySwapchainKHR(logicalDevice, swapChain, nullptr);
+		}
 		vkDestroyDevice(logicalDevice, nullptr);
 #ifdef ENABLE_VALIDATION_LAYERS
 		DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
 #endif
-		vkDestroySurfaceKHR(instance, surface, nullptr);
+		if (!options.headless) {
+			vkDestroySurfaceKHR(instance, surface, nullptr);
+		}
 		vkDestroyInstance(instance, nullptr);
 		SDL_DestroyWindow(window);
 		SDL_Quit();
@@ -120,6 +392,7 @@ private: // Private functions
 	const int HEIGHT{ 600 };
 	SDL_Window* window = nullptr;
 	bool running{};
+	const HelloTriangleOptions options;
 	// Vulkan member variables
 	VkInstance instance = VK_NULL_HANDLE;
 	const std::vector<const char*> validationLayers = {
@@ -135,26 +408,161 @@ private: // Private functions
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 	VkSwapchainKHR swapChain = VK_NULL_HANDLE;
-	std::vector<VkImage> swapChainImages{};
+	std::vector<VkImage> swapChainImages{}; // Offscreen targets when headless
+	std::vector<VkDeviceMemory> offscreenImageMemory{};
 	VkFormat swapChainImageFormat = VK_FORMAT_UNDEFINED;
 	VkExtent2D swapChainExtent{};
 	std::vector<VkImageView> swapChainImageViews;
 	VkRenderPass renderPass = VK_NULL_HANDLE;
 	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 	VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE; // Shared by every pipeline creation
+	struct CachedShaderModule {
+		std::vector<uint32_t> code; // Compared on a hash match so a collision never hands out the wrong module
+		VkShaderModule shaderModule;
+	};
+	std::unordered_multimap<uint64_t, CachedShaderModule> shaderModules; // By hash of the SPIR-V, shared by every pipeline using the same code
+	size_t shaderLoadCount = 0;
+	std::unique_ptr<MappedFile> assetArchive; // Mapped once, shaders are looked up in its index instead of each opening a file
+	size_t archiveLoadCount = 0;
+	// Shader hot reload, the watcher thread owns the watched shaders and their modules until it is joined
+	std::thread shaderWatcher;
+	std::atomic<bool> watchingShaders{ false };
+	std::unordered_map<std::string, VkShaderModule> watchedShaders; // The module each compiled shader in use currently resolves to
+	std::vector<VkShaderModule> reloadedShaderModules; // Compiled by the watcher, the rest belong to shaderModules
+	struct ReloadedPipelines {
+		VkPipeline graphics = VK_NULL_HANDLE;
+		VkPipeline cull = VK_NULL_HANDLE;
+		VkPipeline animate = VK_NULL_HANDLE;
+	};
+	std::mutex reloadMutex;
+	ReloadedPipelines pendingReload; // Built by the watcher and not yet swapped in, guarded by reloadMutex
+	struct RetiredPipeline {
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		size_t retiredAt = 0; // Frame number at the time of the swap
+	};
+	std::deque<RetiredPipeline> retiredPipelines;
+	size_t pipelineGeneration = 0; // Bumped on every swap, static command buffers bind the compute pipelines too
+	bool pipelineCacheWarm = false;
 	std::vector<VkFramebuffer> swapChainFramebuffers;
 	VkCommandPool commandPool = VK_NULL_HANDLE;
 	std::vector<VkCommandBuffer> commandBuffers;
-	std::vector<VkSemaphore> imageAvailableSemaphores;
-	std::vector<VkSemaphore> renderFinishedSemaphores;
-	std::vector<VkFence> inFlightFences;
+	// Pre-recorded command buffers by frame slot then image, each slot has its own timestamp pool so images alone are not enough
+	struct StaticCommands {
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		// What the recording captured, a mismatch with the current state means it has to be recorded again
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkExtent2D extent{};
+		size_t swapChainGeneration = 0;
+		size_t pipelineGeneration = 0;
+	};
+	std::vector<std::vector<StaticCommands>> staticCommands;
+	size_t swapChainGeneration = 1; // Bumped on recreation, handles of destroyed framebuffers may be reused by new ones
+	Uint64 recordTicks = 0;
+	size_t recordCount = 0;
+	std::vector<VkSemaphore> imageAvailableSemaphores; // One per frame in flight
+	std::vector<VkSemaphore> renderFinishedSemaphores; // One per swapchain image, presentation holds it until the image comes back
+	std::vector<VkFence> inFlightFences; // One per frame in flight
+	std::vector<VkFence> imagesInFlight; // Fence of the frame last rendered into each swapchain image
+	bool framebufferResized = false;
+	// Swap chains replaced on resize, destroyed once every frame that could still use them has retired
+	struct RetiredSwapChain {
+		VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+		std::vector<VkImageView> imageViews;
+		std::vector<VkFramebuffer> framebuffers;
+		std::vector<VkSemaphore> renderFinishedSemaphores;
+		size_t retiredAt = 0; // Frame number at the time of the resize
+	};
+	std::deque<RetiredSwapChain> retiredSwapChains;
 	size_t currentFrame = 0;
+	Uint64 fenceWaitTicks = 0;
+	size_t frameNumber = 0;
+	// Host visible copies of the offscreen targets, one persistently mapped buffer per frame in flight
+	std::vector<VkBuffer> readbackBuffers;
+	std::vector<VkDeviceMemory> readbackMemory;
+	std::vector<void*> readbackMapped;
+	std::vector<std::optional<size_t>> readbackPending; // Frame number waiting to be collected from each buffer
+	VkDeviceSize readbackSize = 0;
+	bool readbackCoherent = false;
+	size_t readbackFrameCount = 0;
+	// Geometry, uploaded once into device local buffers
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+	// A begin and end timestamp around the render pass for each frame in flight, read back once the frame's fence signals
+	std::vector<VkQueryPool> timestampQueryPools;
+	std::vector<bool> timestampsPending;
+	double timestampPeriodMs = 0.0;
+	uint64_t timestampMask = 0;
+	std::vector<double> renderPassTimes;
+	// GPU driven drawing, a compute pass culls the objects and writes the indirect draws the render pass consumes
+	struct GpuObject {
+		glm::vec2 position;
+		float scale;
+		float radius; // Of the scaled mesh's bounding circle
+	};
+	struct CullUniforms {
+		glm::vec2 camera;
+		uint32_t objectCount;
+		uint32_t indexCount;
+	};
+	VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool cullDescriptorPool = VK_NULL_HANDLE;
+	VkPipeline cullPipeline = VK_NULL_HANDLE;
+	VkBuffer objectBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory objectBufferMemory = VK_NULL_HANDLE;
+	float worldExtent = 0.0f; // Objects are spread over -worldExtent to worldExtent on both axes
+	// One of each per frame in flight, so a frame's culling never overwrites draws an earlier frame is still reading
+	std::vector<VkDescriptorSet> cullDescriptorSets;
+	std::vector<VkBuffer> drawCommandBuffers;
+	std::vector<VkDeviceMemory> drawCommandMemory;
+	std::vector<VkBuffer> drawCountBuffers;
+	std::vector<VkDeviceMemory> drawCountMemory;
+	std::vector<VkBuffer> cullUniformBuffers;
+	std::vector<VkDeviceMemory> cullUniformMemory;
+	std::vector<void*> cullUniformMapped;
+	// Instanced drawing, every instance orbits its own point so positions are rewritten each frame
+	struct AnimateUniforms {
+		float cosAngle;
+		float sinAngle;
+		uint32_t instanceCount;
+	};
+	float instanceScale = 1.0f;
+	VkBuffer instanceColorBuffer = VK_NULL_HANDLE; // Static, one R8G8B8A8 color per instance
+	VkDeviceMemory instanceColorMemory = VK_NULL_HANDLE;
+	// Orbit centers and signed radii, as separate arrays for SSE on the CPU or packed into a storage buffer for the compute shader
+	std::vector<float> instanceBaseX;
+	std::vector<float> instanceBaseY;
+	std::vector<float> instanceRadius;
+	VkBuffer instanceBaseBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory instanceBaseMemory = VK_NULL_HANDLE;
+	// One position stream per frame in flight, mapped when the CPU writes it
+	std::vector<VkBuffer> instancePositionBuffers;
+	std::vector<VkDeviceMemory> instancePositionMemory;
+	std::vector<void*> instancePositionMapped;
+	VkDescriptorSetLayout animateSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool animateDescriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSet> animateDescriptorSets;
+	VkPipeline animatePipeline = VK_NULL_HANDLE;
+	std::vector<VkBuffer> animateUniformBuffers;
+	std::vector<VkDeviceMemory> animateUniformMemory;
+	std::vector<void*> animateUniformMapped;
+	Uint64 animateTicks = 0;
 #pragma endregion
 #pragma region Internal_Functions
 	void initWindow() {
+		if (options.headless) {
+			// No video driver needed, only the timer for frame statistics
+			SDL_Init(SDL_INIT_TIMER);
+			return;
+		}
 		SDL_Init(SDL_INIT_VIDEO);
 		window = SDL_CreateWindow("Hello Triangle", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-			WIDTH, HEIGHT, SDL_WINDOW_VULKAN);
+			WIDTH, HEIGHT, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 		if (window == nullptr) {
 			throw std::runtime_error("failed to create SDL window");
 		}
@@ -166,23 +574,102 @@ private: // Private functions
 		createWindowSurface();
 		pickPhysicalDevice();
 		createLogicalDevice();
-		createSwapChain();
+		if (options.headless) {
+			createOffscreenTargets();
+		}
+		else {
+			createSwapChain();
+		}
 		createSwapChainImageViews();
 		createRenderPass();
+		createPipelineCache();
+		openAssetArchive();
+		if (gpuDriven()) {
+			createCullSetLayout();
+		}
+		if (instanced() && options.gpuAnimation) {
+			createAnimateSetLayout();
+		}
+		createPipelineLayout();
+		auto pipelineStart = std::chrono::steady_clock::now();
 		createGraphicsPipeline();
+		if (gpuDriven()) {
+			createCullPipeline();
+		}
+		if (instanced() && options.gpuAnimation) {
+			createAnimatePipeline();
+		}
+		std::chrono::duration<double, std::milli> pipelineTime = std::chrono::steady_clock::now() - pipelineStart;
+		std::cout << "Pipeline creation took " << pipelineTime.count() << "ms with a " << (pipelineCacheWarm ? "warm" : "cold") << " pipeline cache, "
+			<< shaderLoadCount << " shaders (" << archiveLoadCount << " from the asset archive) loaded into " << shaderModules.size() << " modules" << std::endl;
+		if (!options.hotReloadDirectory.empty()) {
+			startShaderWatcher();
+		}
 		createFramebuffers();
 		createCommandPool();
+		buildMesh();
+		createVertexBuffer();
+		createIndexBuffer();
+		if (gpuDriven()) {
+			createGpuDrivenBuffers();
+			createCullDescriptorSets();
+		}
+		if (instanced()) {
+			createInstanceBuffers();
+			if (options.gpuAnimation) {
+				createAnimateDescriptorSets();
+			}
+		}
 		createCommandBuffer();
 		createSyncObjects();
+		createTimestampQueries();
+		if (readbackEnabled()) {
+			createReadbackBuffers();
+		}
 	}
 	void drawFrame() {
+		Uint64 waitStart = SDL_GetPerformanceCounter();
 		vkWaitForFences(logicalDevice, 1, &inFlightFences.at(currentFrame), VK_TRUE, UINT64_MAX);
-		vkResetFences(logicalDevice, 1, &inFlightFences.at(currentFrame));
+		fenceWaitTicks += SDL_GetPerformanceCounter() - waitStart;
+		collectTimestamps(currentFrame);
+		if (!options.hotReloadDirectory.empty()) {
+			applyShaderReload();
+		}
+		if (gpuDriven()) {
+			updateCullUniforms();
+		}
+		if (instanced()) {
+			animateInstances();
+		}
+		if (options.headless) {
+			vkResetFences(logicalDevice, 1, &inFlightFences.at(currentFrame));
+			drawOffscreenFrame();
+			return;
+		}
 
+		destroyRetiredSwapChains();
 		unsigned imageIndex;
-		vkAcquireNextImageKHR(logicalDevice, swapChain, UINT64_MAX, imageAvailableSemaphores.at(currentFrame), inFlightFences.at(currentFrame), &imageIndex);
-		vkResetCommandBuffer(commandBuffers.at(currentFrame), 0);
-		recordCommandBuffer(commandBuffers.at(currentFrame), imageIndex);
+		VkResult acquireResult = vkAcquireNextImageKHR(logicalDevice, swapChain, UINT64_MAX, imageAvailableSemaphores.at(currentFrame), VK_NULL_HANDLE, &imageIndex);
+		if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+			// Nothing was acquired and the fence was left signaled, so the frame can simply be tried again
+			recreateSwapChain();
+			return;
+		}
+		if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR) {
+			throw std::runtime_error("failed to acquire swap chain image");
+		}
+		// The swapchain can hand back images out of order, so the image may still be used by a different frame slot
+		if (imagesInFlight.at(imageIndex) != VK_NULL_HANDLE && imagesInFlight.at(imageIndex) != inFlightFences.at(currentFrame)) {
+			waitStart = SDL_GetPerformanceCounter();
+			vkWaitForFences(logicalDevice, 1, &imagesInFlight.at(imageIndex), VK_TRUE, UINT64_MAX);
+			fenceWaitTicks += SDL_GetPerformanceCounter() - waitStart;
+		}
+		imagesInFlight.at(imageIndex) = inFlightFences.at(currentFrame);
+		vkResetFences(logicalDevice, 1, &inFlightFences.at(currentFrame));
+		VkCommandBuffer commandBuffer = prepareCommandBuffer(imageIndex);
+		if (!timestampQueryPools.empty()) {
+			timestampsPending.at(currentFrame) = true;
+		}
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		submitInfo.waitSemaphoreCount = 1;
@@ -190,9 +677,9 @@ private: // Private functions
 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffers.at(currentFrame);
+		submitInfo.pCommandBuffers = &commandBuffer;
 		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &renderFinishedSemaphores.at(currentFrame);
+		submitInfo.pSignalSemaphores = &renderFinishedSemaphores.at(imageIndex);
 
 		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences.at(currentFrame)) != VK_SUCCESS) {
 			throw std::runtime_error("failed to submit draw command buffer");
@@ -201,13 +688,144 @@ private: // Private functions
 		VkPresentInfoKHR presentInfo{};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = &renderFinishedSemaphores.at(currentFrame);
+		presentInfo.pWaitSemaphores = &renderFinishedSemaphores.at(imageIndex);
 		presentInfo.swapchainCount = 1;
 		presentInfo.pSwapchains = &swapChain;
 		presentInfo.pImageIndices = &imageIndex;
 
-		vkQueuePresentKHR(presentQueue, &presentInfo);
-		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		VkResult presentResult = vkQueuePresentKHR(presentQueue, &presentInfo);
+		frameNumber++;
+		currentFrame = (currentFrame + 1) % options.framesInFlight;
+		if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || framebufferResized) {
+			recreateSwapChain();
+		}
+		else if (presentResult != VK_SUCCESS) {
+			throw std::runtime_error("failed to present swap chain image");
+		}
+	}
+	// Builds a new swap chain from the old one without idling the device, the old resources are kept until their frames retire
+	void recreateSwapChain() {
+		framebufferResized = false;
+		RetiredSwapChain retired;
+		retired.swapChain = swapChain;
+		retired.imageViews = std::move(swapChainImageViews);
+		retired.framebuffers = std::move(swapChainFramebuffers);
+		retired.renderFinishedSemaphores = std::move(renderFinishedSemaphores);
+		retired.retiredAt = frameNumber;
+		createSwapChain();
+		retiredSwapChains.push_back(std::move(retired));
+		createSwapChainImageViews();
+		createFramebuffers();
+		createRenderFinishedSemaphores();
+		swapChainGeneration++;
+		// Fences of the old images say nothing about the new ones, the frame fences still guard the command buffers
+		imagesInFlight.assign(swapChainImages.size(), VK_NULL_HANDLE);
+	}
+	// Every frame slot's fence has been waited on since a swap chain was retired once framesInFlight frames have passed
+	void destroyRetiredSwapChains() {
+		while (!retiredSwapChains.empty() && frameNumber >= retiredSwapChains.front().retiredAt + options.framesInFlight) {
+			destroySwapChainResources(retiredSwapChains.front());
+			retiredSwapChains.pop_front();
+		}
+	}
+	void destroySwapChainResources(const RetiredSwapChain& retired) {
+		for (VkFramebuffer framebuffer : retired.framebuffers) {
+			vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+		}
+		for (VkImageView imageView : retired.imageViews) {
+			vkDestroyImageView(logicalDevice, imageView, nullptr);
+		}
+		for (VkSemaphore semaphore : retired.renderFinishedSemaphores) {
+			vkDestroySemaphore(logicalDevice, semaphore, nullptr);
+		}
+		vkDestroySwapchainKHR(logicalDevice, retired.swapChain, nullptr);
+	}
+	// Each frame in flight owns one offscreen target, so there is nothing to acquire, wait on or present
+	void drawOffscreenFrame() {
+		unsigned imageIndex = static_cast<unsigned>(currentFrame);
+		if (readbackEnabled()) {
+			// The fence for this slot has signaled, so the copy made framesInFlight frames ago is complete
+			collectReadback(currentFrame);
+		}
+		VkCommandBuffer commandBuffer = prepareCommandBuffer(imageIndex);
+		if (!timestampQueryPools.empty()) {
+			timestampsPending.at(currentFrame) = true;
+		}
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences.at(currentFrame)) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit draw command buffer");
+		}
+		if (readbackEnabled()) {
+			readbackPending.at(currentFrame) = frameNumber;
+		}
+		frameNumber++;
+		currentFrame = (currentFrame + 1) % options.framesInFlight;
+	}
+	// Returns this frame's command buffer, only recording it when static commands are off or what they captured has changed
+	VkCommandBuffer prepareCommandBuffer(unsigned imageIndex) {
+		Uint64 recordStart = SDL_GetPerformanceCounter();
+		VkCommandBuffer commandBuffer = commandBuffers.at(currentFrame);
+		if (options.staticCommands) {
+			std::vector<StaticCommands>& slotCommands = staticCommands.at(currentFrame);
+			if (slotCommands.size() <= imageIndex) {
+				slotCommands.resize(imageIndex + 1);
+			}
+			StaticCommands& commands = slotCommands.at(imageIndex);
+			VkFramebuffer framebuffer = swapChainFramebuffers.at(imageIndex);
+			bool dirty = commands.framebuffer != framebuffer || commands.pipeline != graphicsPipeline
+				|| commands.extent.width != swapChainExtent.width || commands.extent.height != swapChainExtent.height
+				|| commands.swapChainGeneration != swapChainGeneration || commands.pipelineGeneration != pipelineGeneration;
+			if (!dirty) {
+				// The slot's fence has signaled, so the last submission of this buffer is complete and it can go again as is
+				recordTicks += SDL_GetPerformanceCounter() - recordStart;
+				return commands.commandBuffer;
+			}
+			if (commands.commandBuffer == VK_NULL_HANDLE) {
+				VkCommandBufferAllocateInfo allocInfo{};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandPool = commandPool;
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocInfo.commandBufferCount = 1;
+				if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commands.commandBuffer) != VK_SUCCESS) {
+					throw std::runtime_error("failed to allocate static command buffer");
+				}
+			}
+			commands.framebuffer = framebuffer;
+			commands.pipeline = graphicsPipeline;
+			commands.extent = swapChainExtent;
+			commands.swapChainGeneration = swapChainGeneration;
+			commands.pipelineGeneration = pipelineGeneration;
+			commandBuffer = commands.commandBuffer;
+		}
+		vkResetCommandBuffer(commandBuffer, 0);
+		recordCommandBuffer(commandBuffer, imageIndex);
+		recordCount++;
+		recordTicks += SDL_GetPerformanceCounter() - recordStart;
+		return commandBuffer;
+	}
+	// Handing a finished frame's pixels to the CPU, only called once the frame's fence has signaled
+	void collectReadback(size_t slot) {
+		if (!readbackPending.at(slot).has_value()) {
+			return;
+		}
+		size_t frame = readbackPending.at(slot).value();
+		readbackPending.at(slot).reset();
+		if (!readbackCoherent) {
+			VkMappedMemoryRange range{};
+			range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+			range.memory = readbackMemory.at(slot);
+			range.offset = 0;
+			range.size = VK_WHOLE_SIZE;
+			vkInvalidateMappedMemoryRanges(logicalDevice, 1, &range);
+		}
+		readbackFrameCount++;
+		if (!options.dumpPath.empty() && frame + 1 == options.frameCount) {
+			writeImage(options.dumpPath, static_cast<const unsigned char*>(readbackMapped.at(slot)), swapChainExtent);
+		}
 	}
 #pragma endregion
 #pragma region Vulkan_Instanciation_Functions
@@ -227,7 +845,8 @@ private: // Private functions
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		// Indirect draws with a GPU written count are core in 1.2
+		appInfo.apiVersion = gpuDriven() ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
 
 		// Querying for general device capabilities via extensions
 		auto extensions = getRequiredExtensions();
@@ -305,14 +924,24 @@ private: // Private functions
 		}
 		// Specifying device features that are required on the logical device
 		VkPhysicalDeviceFeatures deviceFeatures{};
+		VkPhysicalDeviceVulkan12Features vulkan12Features{};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		if (gpuDriven()) {
+			requireGpuDrivenFeatures();
+			deviceFeatures.multiDrawIndirect = VK_TRUE;
+			deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+			vulkan12Features.drawIndirectCount = VK_TRUE;
+		}
 		// Putting all together in the device create info
 		VkDeviceCreateInfo deviceCreateInfo{};
 		deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		deviceCreateInfo.pNext = gpuDriven() ? &vulkan12Features : nullptr;
 		deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
 		deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
 		deviceCreateInfo.queueCreateInfoCount = static_cast<unsigned>(queueCreateInfos.size());
-		deviceCreateInfo.enabledExtensionCount = static_cast<unsigned>(deviceExtensions.size());
-		deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
+		const auto& extensions = requiredDeviceExtensions();
+		deviceCreateInfo.enabledExtensionCount = static_cast<unsigned>(extensions.size());
+		deviceCreateInfo.ppEnabledExtensionNames = extensions.data();
 #ifdef ENABLE_VALIDATION_LAYERS
 		// For older version compatibility 
 		deviceCreateInfo.enabledLayerCount = static_cast<unsigned>(validationLayers.size());
@@ -328,6 +957,9 @@ private: // Private functions
 	}
 	// Creating a surface to display graphics on
 	void createWindowSurface() {
+		if (options.headless) {
+			return;
+		}
 		if (SDL_Vulkan_CreateSurface(window, instance, &surface) != SDL_TRUE) {
 			throw std::runtime_error("failed to create window surface");
 		}
@@ -367,7 +999,7 @@ private: // Private functions
 		createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR; // Do not use alpha to modify the window's transparency
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE; // Enables window clipping
-		createInfo.oldSwapchain = VK_NULL_HANDLE;
+		createInfo.oldSwapchain = swapChain; // Handing over the old swap chain lets presentation continue while the new one is built
 		if (vkCreateSwapchainKHR(logicalDevice, &createInfo, nullptr, &swapChain)) {
 			throw std::runtime_error("failed to create swap chain");
 		}
@@ -377,6 +1009,40 @@ private: // Private functions
 		swapChainImageFormat = surfaceFormat.format;
 		swapChainExtent = extent;
 	}
+	// Creating the ring of images rendered to in place of the swap chain when headless
+	void createOffscreenTargets() {
+		swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+		swapChainExtent = { static_cast<unsigned>(WIDTH), static_cast<unsigned>(HEIGHT) };
+		swapChainImages.resize(options.framesInFlight);
+		offscreenImageMemory.resize(options.framesInFlight);
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			VkImageCreateInfo imageCreateInfo{};
+			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.format = swapChainImageFormat;
+			imageCreateInfo.extent = { swapChainExtent.width, swapChainExtent.height, 1 };
+			imageCreateInfo.mipLevels = 1;
+			imageCreateInfo.arrayLayers = 1;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // Transfer source so frames can be copied out
+			imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			if (vkCreateImage(logicalDevice, &imageCreateInfo, nullptr, &swapChainImages.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create offscreen image");
+			}
+			VkMemoryRequirements memRequirements;
+			vkGetImageMemoryRequirements(logicalDevice, swapChainImages.at(i), &memRequirements);
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = memRequirements.size;
+			allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			if (vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &offscreenImageMemory.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate offscreen image memory");
+			}
+			vkBindImageMemory(logicalDevice, swapChainImages.at(i), offscreenImageMemory.at(i), 0);
+		}
+	}
 	void createSwapChainImageViews() {
 		swapChainImageViews.resize(swapChainImages.size());
 		for (size_t i = 0; i < swapChainImages.size(); i++) {
@@ -409,6 +1075,9 @@ private: // Private functions
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Dont care what image was used for previously
 		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // Transition to present on the swap chain after processing
+		if (options.headless) {
+			colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // Nothing presents offscreen targets, leave them ready to copy out
+		}
 
 		// Setting up the output color ie layout (location = 0)
 		VkAttachmentReference colorAttachmentRef{};
@@ -427,26 +1096,79 @@ private: // Private functions
 		renderPassCreateInfo.pSubpasses = &subpass;
 		renderPassCreateInfo.subpassCount = 1;
 
-		VkSubpassDependency dependency{};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		renderPassCreateInfo.dependencyCount = 1;
-		renderPassCreateInfo.pDependencies = &dependency;
+		VkSubpassDependency dependencies[2]{};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].srcAccessMask = 0;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		// Making the color writes visible to the copy into the readback buffer
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		renderPassCreateInfo.dependencyCount = options.headless ? 2 : 1;
+		renderPassCreateInfo.pDependencies = dependencies;
 		if (vkCreateRenderPass(logicalDevice, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create render pass");
 		}
 	}
+	// Creating the pipeline cache, seeded from disk when the saved data was written by this device and driver
+	void createPipelineCache() {
+		std::vector<char> cacheData;
+		if (std::filesystem::exists(options.pipelineCachePath)) {
+			cacheData = readFile(options.pipelineCachePath);
+		}
+		pipelineCacheWarm = isPipelineCacheCompatible(cacheData);
+		if (!cacheData.empty() && !pipelineCacheWarm) {
+			std::cerr << "ignoring pipeline cache '" << options.pipelineCachePath << "' written by another device or driver" << std::endl;
+		}
+		VkPipelineCacheCreateInfo cacheCreateInfo{};
+		cacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheCreateInfo.initialDataSize = pipelineCacheWarm ? cacheData.size() : 0;
+		cacheCreateInfo.pInitialData = pipelineCacheWarm ? cacheData.data() : nullptr;
+		if (vkCreatePipelineCache(logicalDevice, &cacheCreateInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache");
+		}
+	}
+	// Writing the cache to a temporary file and renaming it over the old one so an interrupted write never leaves a torn cache
+	void savePipelineCache() const {
+		size_t cacheSize = 0;
+		if (vkGetPipelineCacheData(logicalDevice, pipelineCache, &cacheSize, nullptr) != VK_SUCCESS || cacheSize == 0) {
+			return;
+		}
+		std::vector<char> cacheData(cacheSize);
+		if (vkGetPipelineCacheData(logicalDevice, pipelineCache, &cacheSize, cacheData.data()) != VK_SUCCESS) {
+			std::cerr << "failed to get pipeline cache data" << std::endl;
+			return;
+		}
+		std::string tempPath = options.pipelineCachePath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open() || !file.write(cacheData.data(), cacheSize)) {
+				std::cerr << "failed to write pipeline cache '" << tempPath << "'" << std::endl;
+				return;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, options.pipelineCachePath, error);
+		if (error) {
+			std::cerr << "failed to replace pipeline cache '" << options.pipelineCachePath << "': " << error.message() << std::endl;
+			std::filesystem::remove(tempPath, error);
+		}
+	}
 	// Creating a simple graphics pipeline for displaying a triangle
+	std::string vertexShaderPath() const {
+		return gpuDriven() ? "shaders/gpu_driven.vert.spv" : instanced() ? "shaders/instanced.vert.spv" : "shaders/vert.spv";
+	}
 	void createGraphicsPipeline() {
-		auto vertShaderCode = readFile("shaders/vert.spv");
-		auto fragShaderCode = readFile("shaders/frag.spv");
-		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
+		graphicsPipeline = buildGraphicsPipeline(loadShaderModule(vertexShaderPath()), loadShaderModule("shaders/frag.spv"));
+	}
+	// Only reads state that is fixed after startup, so shader hot reload can build pipelines on its own thread
+	VkPipeline buildGraphicsPipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule) const {
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
 		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -464,27 +1186,27 @@ private: // Private functions
 		// Specifying how the mesh data should be interpreted
 		VkPipelineVertexInputStateCreateInfo vertInputCreateInfo{};
 		vertInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertInputCreateInfo.vertexBindingDescriptionCount = 0;
-		vertInputCreateInfo.vertexAttributeDescriptionCount = 0;
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions = { Vertex::getBindingDescription() };
+		auto vertexAttributes = Vertex::getAttributeDescriptions();
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(vertexAttributes.begin(), vertexAttributes.end());
+		if (instanced()) {
+			// Positions and colors advance once per instance, from separate bindings since only the positions change
+			bindingDescriptions.push_back({ 1, sizeof(glm::vec2), VK_VERTEX_INPUT_RATE_INSTANCE });
+			bindingDescriptions.push_back({ 2, sizeof(uint32_t), VK_VERTEX_INPUT_RATE_INSTANCE });
+			attributeDescriptions.push_back({ 2, 1, VK_FORMAT_R32G32_SFLOAT, 0 });
+			attributeDescriptions.push_back({ 3, 2, VK_FORMAT_R8G8B8A8_UNORM, 0 });
+		}
+		vertInputCreateInfo.vertexBindingDescriptionCount = static_cast<unsigned>(bindingDescriptions.size());
+		vertInputCreateInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+		vertInputCreateInfo.vertexAttributeDescriptionCount = static_cast<unsigned>(attributeDescriptions.size());
+		vertInputCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
 		VkPipelineInputAssemblyStateCreateInfo assemblyCreateInfo{};
 		assemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 		assemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 		assemblyCreateInfo.primitiveRestartEnable = VK_FALSE; // For most cases it should be VK_TRUE
 		
-		// Describing the area of the view buffer to display the image to.
-		VkViewport viewPort{};
-		viewPort.x = 0.0f;
-		viewPort.y = 0.0f;
-		viewPort.width = (float)swapChainExtent.width;
-		viewPort.height = (float)swapChainExtent.height;
-		viewPort.minDepth = 0.0f;
-		viewPort.maxDepth = 1.0f;
-
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };
-		scissor.extent = swapChainExtent;
-
+		// The area of the view buffer to display the image to is set when recording, so the pipeline outlives swap chain resizes
 		std::vector<VkDynamicState> dynamicStates = {
 			VK_DYNAMIC_STATE_VIEWPORT,
 			VK_DYNAMIC_STATE_SCISSOR
@@ -498,9 +1220,7 @@ private: // Private functions
 		VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
 		viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 		viewportStateCreateInfo.viewportCount = 1;
-		viewportStateCreateInfo.pViewports = &viewPort;
 		viewportStateCreateInfo.scissorCount = 1;
-		viewportStateCreateInfo.pScissors = &scissor;
 
 		VkPipelineRasterizationStateCreateInfo rasterCreateInfo{};
 		rasterCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -528,13 +1248,6 @@ private: // Private functions
 		colorBlendCreateInfo.attachmentCount = 1;
 		colorBlendCreateInfo.pAttachments = &colorBlendAttachment;
 
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-
-		if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create pipeline layout");
-		}
-
 		VkGraphicsPipelineCreateInfo graphicsCreateInfo{};
 		graphicsCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 		graphicsCreateInfo.pStages = shaderStages;
@@ -552,11 +1265,332 @@ private: // Private functions
 		graphicsCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 		graphicsCreateInfo.basePipelineIndex = -1;
 
-		if (vkCreateGraphicsPipelines(logicalDevice, VK_NULL_HANDLE, 1, &graphicsCreateInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(logicalDevice, pipelineCache, 1, &graphicsCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline");
 		}
-		vkDestroyShaderModule(logicalDevice, vertShaderModule, nullptr);
-		vkDestroyShaderModule(logicalDevice, fragShaderModule, nullptr);
+		return pipeline;
+	}
+	void createPipelineLayout() {
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		// The culling pipeline shares this layout, so the set bound once serves both passes
+		if (gpuDriven()) {
+			pipelineLayoutCreateInfo.setLayoutCount = 1;
+			pipelineLayoutCreateInfo.pSetLayouts = &cullSetLayout;
+		}
+		VkPushConstantRange instanceScaleRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) };
+		if (instanced()) {
+			pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+			pipelineLayoutCreateInfo.pPushConstantRanges = &instanceScaleRange;
+			// Likewise shared with the animation pipeline
+			if (options.gpuAnimation) {
+				pipelineLayoutCreateInfo.setLayoutCount = 1;
+				pipelineLayoutCreateInfo.pSetLayouts = &animateSetLayout;
+			}
+		}
+
+		if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout");
+		}
+	}
+	// Objects, draws and count are storage buffers, the camera a uniform buffer read by both culling and vertex shading
+	void createCullSetLayout() {
+		std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+		for (unsigned i = 0; i < bindings.size(); i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		bindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+		bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[3].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutCreateInfo.bindingCount = static_cast<unsigned>(bindings.size());
+		layoutCreateInfo.pBindings = bindings.data();
+		if (vkCreateDescriptorSetLayout(logicalDevice, &layoutCreateInfo, nullptr, &cullSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create culling descriptor set layout");
+		}
+	}
+	void createCullPipeline() {
+		cullPipeline = buildComputePipeline(loadShaderModule("shaders/cull.comp.spv"));
+	}
+	// Compute pipelines share the graphics pipeline layout, so the descriptor set bound for one pass serves the other
+	VkPipeline buildComputePipeline(VkShaderModule compShaderModule) const {
+		VkComputePipelineCreateInfo computeCreateInfo{};
+		computeCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		computeCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		computeCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		computeCreateInfo.stage.module = compShaderModule;
+		computeCreateInfo.stage.pName = "main";
+		computeCreateInfo.layout = pipelineLayout;
+		computeCreateInfo.basePipelineIndex = -1;
+
+		VkPipeline pipeline;
+		if (vkCreateComputePipelines(logicalDevice, pipelineCache, 1, &computeCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute pipeline");
+		}
+		return pipeline;
+	}
+	// Scatters the objects over a grid about ten times the area of the view, so most of them are culled at any time
+	void createGpuDrivenBuffers() {
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+		if (options.gpuDrivenObjects > deviceProperties.limits.maxDrawIndirectCount) {
+			throw std::runtime_error("more gpu driven objects than the device can draw indirectly");
+		}
+		float meshRadius = getMeshRadius();
+		size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(options.gpuDrivenObjects))));
+		worldExtent = std::sqrt(10.0f);
+		float spacing = 2.0f * worldExtent / columns;
+		std::vector<GpuObject> objects(options.gpuDrivenObjects);
+		for (size_t i = 0; i < objects.size(); i++) {
+			objects[i].position = glm::vec2(-worldExtent + (i % columns + 0.5f) * spacing, -worldExtent + (i / columns + 0.5f) * spacing);
+			// Scaled so the mesh's bounding circle fills 80% of its cell
+			objects[i].scale = 0.4f * spacing / meshRadius;
+			objects[i].radius = 0.4f * spacing;
+		}
+		createDeviceLocalBuffer(objects.data(), sizeof(GpuObject) * objects.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, objectBuffer, objectBufferMemory);
+
+		drawCommandBuffers.resize(options.framesInFlight);
+		drawCommandMemory.resize(options.framesInFlight);
+		drawCountBuffers.resize(options.framesInFlight);
+		drawCountMemory.resize(options.framesInFlight);
+		cullUniformBuffers.resize(options.framesInFlight);
+		cullUniformMemory.resize(options.framesInFlight);
+		cullUniformMapped.resize(options.framesInFlight);
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			createBuffer(sizeof(VkDrawIndexedIndirectCommand) * objects.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCommandBuffers.at(i), drawCommandMemory.at(i));
+			createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCountBuffers.at(i), drawCountMemory.at(i));
+			createBuffer(sizeof(CullUniforms), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cullUniformBuffers.at(i), cullUniformMemory.at(i));
+			if (vkMapMemory(logicalDevice, cullUniformMemory.at(i), 0, VK_WHOLE_SIZE, 0, &cullUniformMapped.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to map culling uniforms");
+			}
+		}
+		std::cout << "Culling " << objects.size() << " objects on the GPU" << std::endl;
+	}
+	void createCullDescriptorSets() {
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[0].descriptorCount = static_cast<unsigned>(3 * options.framesInFlight);
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[1].descriptorCount = static_cast<unsigned>(options.framesInFlight);
+		VkDescriptorPoolCreateInfo poolCreateInfo{};
+		poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolCreateInfo.maxSets = static_cast<unsigned>(options.framesInFlight);
+		poolCreateInfo.poolSizeCount = static_cast<unsigned>(poolSizes.size());
+		poolCreateInfo.pPoolSizes = poolSizes.data();
+		if (vkCreateDescriptorPool(logicalDevice, &poolCreateInfo, nullptr, &cullDescriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create culling descriptor pool");
+		}
+
+		std::vector<VkDescriptorSetLayout> setLayouts(options.framesInFlight, cullSetLayout);
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = cullDescriptorPool;
+		allocInfo.descriptorSetCount = static_cast<unsigned>(setLayouts.size());
+		allocInfo.pSetLayouts = setLayouts.data();
+		cullDescriptorSets.resize(options.framesInFlight);
+		if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, cullDescriptorSets.data()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate culling descriptor sets");
+		}
+
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+			bufferInfos[0] = { objectBuffer, 0, VK_WHOLE_SIZE };
+			bufferInfos[1] = { drawCommandBuffers.at(i), 0, VK_WHOLE_SIZE };
+			bufferInfos[2] = { drawCountBuffers.at(i), 0, VK_WHOLE_SIZE };
+			bufferInfos[3] = { cullUniformBuffers.at(i), 0, VK_WHOLE_SIZE };
+			std::array<VkWriteDescriptorSet, 4> writes{};
+			for (unsigned binding = 0; binding < writes.size(); binding++) {
+				writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writes[binding].dstSet = cullDescriptorSets.at(i);
+				writes[binding].dstBinding = binding;
+				writes[binding].descriptorCount = 1;
+				writes[binding].descriptorType = binding == 3 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writes[binding].pBufferInfo = &bufferInfos[binding];
+			}
+			vkUpdateDescriptorSets(logicalDevice, static_cast<unsigned>(writes.size()), writes.data(), 0, nullptr);
+		}
+	}
+	// The slot's fence has signaled, so nothing still reads its uniforms. The camera circles the world so the visible set keeps changing
+	void updateCullUniforms() {
+		float angle = static_cast<float>(frameNumber) * 0.005f;
+		CullUniforms uniforms{};
+		uniforms.camera = glm::vec2(std::cos(angle), std::sin(angle)) * (worldExtent - 1.0f);
+		uniforms.objectCount = static_cast<uint32_t>(options.gpuDrivenObjects);
+		uniforms.indexCount = static_cast<uint32_t>(indices.size());
+		std::memcpy(cullUniformMapped.at(currentFrame), &uniforms, sizeof(uniforms));
+	}
+	// Bases and positions are storage buffers, the angle a uniform buffer written each frame so static commands stay valid
+	void createAnimateSetLayout() {
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+		for (unsigned i = 0; i < bindings.size(); i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorType = i == 2 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutCreateInfo.bindingCount = static_cast<unsigned>(bindings.size());
+		layoutCreateInfo.pBindings = bindings.data();
+		if (vkCreateDescriptorSetLayout(logicalDevice, &layoutCreateInfo, nullptr, &animateSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create animation descriptor set layout");
+		}
+	}
+	void createAnimatePipeline() {
+		animatePipeline = buildComputePipeline(loadShaderModule("shaders/animate.comp.spv"));
+	}
+	// Lays the instances out on a grid filling the view, each orbiting its cell center clockwise or counter clockwise
+	void createInstanceBuffers() {
+		size_t count = options.instanceCount;
+		size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+		size_t rows = (count + columns - 1) / columns;
+		float spacing = 2.0f / columns;
+		instanceScale = 0.25f * spacing / getMeshRadius();
+		instanceBaseX.resize(count);
+		instanceBaseY.resize(count);
+		instanceRadius.resize(count);
+		std::vector<uint32_t> colors(count);
+		for (size_t i = 0; i < count; i++) {
+			size_t column = i % columns;
+			size_t row = i / columns;
+			instanceBaseX[i] = -1.0f + (column + 0.5f) * spacing;
+			instanceBaseY[i] = -1.0f + (row + 0.5f) * spacing;
+			instanceRadius[i] = (i % 2 ? 0.25f : -0.25f) * spacing;
+			uint32_t red = static_cast<uint32_t>(255 * column / columns);
+			uint32_t green = static_cast<uint32_t>(255 * row / rows);
+			colors[i] = red | green << 8 | (255 - red) << 16 | 255u << 24;
+		}
+		createDeviceLocalBuffer(colors.data(), sizeof(uint32_t) * count, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, instanceColorBuffer, instanceColorMemory);
+
+		VkDeviceSize positionsSize = sizeof(glm::vec2) * count;
+		instancePositionBuffers.resize(options.framesInFlight);
+		instancePositionMemory.resize(options.framesInFlight);
+		instancePositionMapped.resize(options.framesInFlight);
+		if (!options.gpuAnimation) {
+			for (size_t i = 0; i < options.framesInFlight; i++) {
+				createBuffer(positionsSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					instancePositionBuffers.at(i), instancePositionMemory.at(i));
+				if (vkMapMemory(logicalDevice, instancePositionMemory.at(i), 0, VK_WHOLE_SIZE, 0, &instancePositionMapped.at(i)) != VK_SUCCESS) {
+					throw std::runtime_error("failed to map instance positions");
+				}
+			}
+			return;
+		}
+		std::vector<glm::vec4> bases(count);
+		for (size_t i = 0; i < count; i++) {
+			bases[i] = { instanceBaseX[i], instanceBaseY[i], instanceRadius[i], 0.0f };
+		}
+		createDeviceLocalBuffer(bases.data(), sizeof(glm::vec4) * count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, instanceBaseBuffer, instanceBaseMemory);
+		animateUniformBuffers.resize(options.framesInFlight);
+		animateUniformMemory.resize(options.framesInFlight);
+		animateUniformMapped.resize(options.framesInFlight);
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			createBuffer(positionsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				instancePositionBuffers.at(i), instancePositionMemory.at(i));
+			createBuffer(sizeof(AnimateUniforms), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				animateUniformBuffers.at(i), animateUniformMemory.at(i));
+			if (vkMapMemory(logicalDevice, animateUniformMemory.at(i), 0, VK_WHOLE_SIZE, 0, &animateUniformMapped.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to map animation uniforms");
+			}
+		}
+	}
+	void createAnimateDescriptorSets() {
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[0].descriptorCount = static_cast<unsigned>(2 * options.framesInFlight);
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[1].descriptorCount = static_cast<unsigned>(options.framesInFlight);
+		VkDescriptorPoolCreateInfo poolCreateInfo{};
+		poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolCreateInfo.maxSets = static_cast<unsigned>(options.framesInFlight);
+		poolCreateInfo.poolSizeCount = static_cast<unsigned>(poolSizes.size());
+		poolCreateInfo.pPoolSizes = poolSizes.data();
+		if (vkCreateDescriptorPool(logicalDevice, &poolCreateInfo, nullptr, &animateDescriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create animation descriptor pool");
+		}
+
+		std::vector<VkDescriptorSetLayout> setLayouts(options.framesInFlight, animateSetLayout);
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = animateDescriptorPool;
+		allocInfo.descriptorSetCount = static_cast<unsigned>(setLayouts.size());
+		allocInfo.pSetLayouts = setLayouts.data();
+		animateDescriptorSets.resize(options.framesInFlight);
+		if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, animateDescriptorSets.data()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate animation descriptor sets");
+		}
+
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+			bufferInfos[0] = { instanceBaseBuffer, 0, VK_WHOLE_SIZE };
+			bufferInfos[1] = { instancePositionBuffers.at(i), 0, VK_WHOLE_SIZE };
+			bufferInfos[2] = { animateUniformBuffers.at(i), 0, VK_WHOLE_SIZE };
+			std::array<VkWriteDescriptorSet, 3> writes{};
+			for (unsigned binding = 0; binding < writes.size(); binding++) {
+				writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writes[binding].dstSet = animateDescriptorSets.at(i);
+				writes[binding].dstBinding = binding;
+				writes[binding].descriptorCount = 1;
+				writes[binding].descriptorType = binding == 2 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writes[binding].pBufferInfo = &bufferInfos[binding];
+			}
+			vkUpdateDescriptorSets(logicalDevice, static_cast<unsigned>(writes.size()), writes.data(), 0, nullptr);
+		}
+	}
+	// The slot's fence has signaled, so its position stream and uniforms are free to rewrite
+	void animateInstances() {
+		float angle = static_cast<float>(frameNumber) * 0.05f;
+		float cosAngle = std::cos(angle);
+		float sinAngle = std::sin(angle);
+		if (options.gpuAnimation) {
+			AnimateUniforms uniforms{ cosAngle, sinAngle, static_cast<uint32_t>(options.instanceCount) };
+			std::memcpy(animateUniformMapped.at(currentFrame), &uniforms, sizeof(uniforms));
+			return;
+		}
+		Uint64 animateStart = SDL_GetPerformanceCounter();
+		size_t count = options.instanceCount;
+		size_t simdCount = count & ~static_cast<size_t>(3);
+		float* positions = static_cast<float*>(instancePositionMapped.at(currentFrame));
+		// Four instances per iteration with SSE, which every x64 CPU has, interleaved into x, y pairs on the way out
+		__m128 cosines = _mm_set1_ps(cosAngle);
+		__m128 sines = _mm_set1_ps(sinAngle);
+		for (size_t i = 0; i < simdCount; i += 4) {
+			__m128 radius = _mm_loadu_ps(&instanceRadius[i]);
+			__m128 x = _mm_add_ps(_mm_loadu_ps(&instanceBaseX[i]), _mm_mul_ps(radius, cosines));
+			__m128 y = _mm_add_ps(_mm_loadu_ps(&instanceBaseY[i]), _mm_mul_ps(radius, sines));
+			_mm_storeu_ps(positions + 2 * i, _mm_unpacklo_ps(x, y));
+			_mm_storeu_ps(positions + 2 * i + 4, _mm_unpackhi_ps(x, y));
+		}
+		for (size_t i = simdCount; i < count; i++) {
+			positions[2 * i] = instanceBaseX[i] + instanceRadius[i] * cosAngle;
+			positions[2 * i + 1] = instanceBaseY[i] + instanceRadius[i] * sinAngle;
+		}
+		animateTicks += SDL_GetPerformanceCounter() - animateStart;
+	}
+	void requireGpuDrivenFeatures() const {
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+		if (deviceProperties.apiVersion < VK_API_VERSION_1_2) {
+			throw std::runtime_error("gpu driven drawing requires a vulkan 1.2 device");
+		}
+		VkPhysicalDeviceVulkan12Features vulkan12Features{};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		VkPhysicalDeviceFeatures2 features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &vulkan12Features;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+		if (!features.features.multiDrawIndirect || !features.features.drawIndirectFirstInstance || !vulkan12Features.drawIndirectCount) {
+			throw std::runtime_error("gpu driven drawing requires multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount");
+		}
 	}
 	// Creating the framebuffers that links to the swapchain images
 	void createFramebuffers() {
@@ -591,8 +1625,113 @@ private: // Private functions
 		}
 	}
 
+	// The original triangle, or a screen covering grid of small quads in stress mode
+	void buildMesh() {
+		if (options.stressTriangles == 0) {
+			vertices = {
+				{{ 0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+				{{ 0.5f,  0.5f}, {0.0f, 1.0f, 0.0f}},
+				{{-0.5f,  0.5f}, {0.0f, 0.0f, 1.0f}}
+			};
+			indices = { 0, 1, 2 };
+			return;
+		}
+		size_t quadCount = (options.stressTriangles + 1) / 2;
+		size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(quadCount))));
+		size_t rows = (quadCount + columns - 1) / columns;
+		float quadWidth = 2.0f / columns;
+		float quadHeight = 2.0f / rows;
+		vertices.reserve(quadCount * 4);
+		indices.reserve(quadCount * 6);
+		for (size_t quad = 0; quad < quadCount; quad++) {
+			float x = -1.0f + (quad % columns) * quadWidth;
+			float y = -1.0f + (quad / columns) * quadHeight;
+			float u = static_cast<float>(quad % columns) / columns;
+			float v = static_cast<float>(quad / columns) / rows;
+			uint32_t base = static_cast<uint32_t>(vertices.size());
+			// Clockwise on screen to match the pipeline's front face
+			vertices.push_back({ {x, y}, {u, v, 1.0f - u} });
+			vertices.push_back({ {x + quadWidth, y}, {u, v, 1.0f - u} });
+			vertices.push_back({ {x + quadWidth, y + quadHeight}, {u, v, 1.0f - v} });
+			vertices.push_back({ {x, y + quadHeight}, {u, v, 1.0f - v} });
+			indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+		}
+		std::cout << "Stress mesh has " << indices.size() / 3 << " triangles and " << vertices.size() << " vertices" << std::endl;
+	}
+	void createVertexBuffer() {
+		createDeviceLocalBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexBuffer, vertexBufferMemory);
+	}
+	void createIndexBuffer() {
+		createDeviceLocalBuffer(indices.data(), sizeof(indices[0]) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBuffer, indexBufferMemory);
+	}
+	// Uploading through a host visible staging buffer, device local memory is usually not mappable
+	void createDeviceLocalBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		void* mapped;
+		vkMapMemory(logicalDevice, stagingBufferMemory, 0, size, 0, &mapped);
+		std::memcpy(mapped, data, static_cast<size_t>(size));
+		vkUnmapMemory(logicalDevice, stagingBufferMemory);
+
+		createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
+		copyBuffer(stagingBuffer, buffer, size);
+		vkDestroyBuffer(logicalDevice, stagingBuffer, nullptr);
+		vkFreeMemory(logicalDevice, stagingBufferMemory, nullptr);
+	}
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = usage;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(logicalDevice, &bufferCreateInfo, nullptr, &buffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create buffer");
+		}
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(logicalDevice, buffer, &memRequirements);
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+		if (vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate buffer memory");
+		}
+		vkBindBufferMemory(logicalDevice, buffer, bufferMemory, 0);
+	}
+	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = commandPool;
+		allocInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate transfer command buffer");
+		}
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		VkBufferCopy copyRegion{};
+		copyRegion.size = size;
+		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+		// Waiting is fine here, uploads only happen during initialization
+		vkQueueWaitIdle(graphicsQueue);
+		vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+	}
+
 	void createCommandBuffer() {
-		commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		commandBuffers.resize(options.framesInFlight);
+		staticCommands.resize(options.framesInFlight);
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.commandPool = commandPool;
@@ -604,24 +1743,99 @@ private: // Private functions
 		}
 	}
 
+	// Creating the persistently mapped buffers that the offscreen targets are copied into
+	void createReadbackBuffers() {
+		readbackSize = static_cast<VkDeviceSize>(swapChainExtent.width) * swapChainExtent.height * 4; // R8G8B8A8
+		readbackBuffers.resize(options.framesInFlight);
+		readbackMemory.resize(options.framesInFlight);
+		readbackMapped.resize(options.framesInFlight);
+		readbackPending.resize(options.framesInFlight);
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			VkBufferCreateInfo bufferCreateInfo{};
+			bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferCreateInfo.size = readbackSize;
+			bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			if (vkCreateBuffer(logicalDevice, &bufferCreateInfo, nullptr, &readbackBuffers.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create readback buffer");
+			}
+			VkMemoryRequirements memRequirements;
+			vkGetBufferMemoryRequirements(logicalDevice, readbackBuffers.at(i), &memRequirements);
+			// Cached memory makes CPU reads fast, it just needs invalidating when it is not also coherent
+			auto memoryType = tryFindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+			if (!memoryType.has_value()) {
+				memoryType = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			}
+			readbackCoherent = memoryTypeHasProperties(memoryType.value(), VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = memRequirements.size;
+			allocInfo.memoryTypeIndex = memoryType.value();
+			if (vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &readbackMemory.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate readback memory");
+			}
+			vkBindBufferMemory(logicalDevice, readbackBuffers.at(i), readbackMemory.at(i), 0);
+			if (vkMapMemory(logicalDevice, readbackMemory.at(i), 0, VK_WHOLE_SIZE, 0, &readbackMapped.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to map readback memory");
+			}
+		}
+	}
+	void createTimestampQueries() {
+		unsigned queueFamilyCount;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+		unsigned validBits = queueFamilies.at(findQueueFamilies(physicalDevice).graphicsFamily.value()).timestampValidBits;
+		if (validBits == 0) {
+			std::cout << "Timestamps are not supported on the graphics queue, render pass timing is disabled" << std::endl;
+			return;
+		}
+		timestampMask = validBits >= 64 ? UINT64_MAX : (1ULL << validBits) - 1;
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+		timestampPeriodMs = deviceProperties.limits.timestampPeriod / 1e6;
+
+		timestampQueryPools.resize(options.framesInFlight);
+		timestampsPending.resize(options.framesInFlight);
+		for (size_t i = 0; i < options.framesInFlight; i++) {
+			VkQueryPoolCreateInfo queryPoolCreateInfo{};
+			queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolCreateInfo.queryCount = 2;
+			if (vkCreateQueryPool(logicalDevice, &queryPoolCreateInfo, nullptr, &timestampQueryPools.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create timestamp query pool");
+			}
+		}
+	}
 	void createSyncObjects() {
-		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+		imageAvailableSemaphores.resize(options.framesInFlight);
+		inFlightFences.resize(options.framesInFlight);
+		imagesInFlight.assign(swapChainImages.size(), VK_NULL_HANDLE);
 		VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 		VkFenceCreateInfo fenceInfo{};
 		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		for (size_t i = 0; i < options.framesInFlight; i++) {
 			if (
 				vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores.at(i)) != VK_SUCCESS ||
-				vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores.at(i)) != VK_SUCCESS ||
 				vkCreateFence(logicalDevice, &fenceInfo, nullptr, &inFlightFences.at(i))
 				) {
 				throw std::runtime_error("failed to create semaphore sync objects");
 			}
 		}
+		createRenderFinishedSemaphores();
+	}
+	// One per swap chain image, so they are rebuilt along with the swap chain
+	void createRenderFinishedSemaphores() {
+		renderFinishedSemaphores.resize(swapChainImages.size());
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		for (size_t i = 0; i < renderFinishedSemaphores.size(); i++) {
+			if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores.at(i)) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create semaphore sync objects");
+			}
+		}
 	}
 #pragma endregion
 #pragma region Utility_Functions
@@ -668,10 +1882,14 @@ private: // Private functions
 		return true;
 	}
 	std::vector<const char*> getRequiredExtensions() const {
-		unsigned sdlExtensionCount;
-		SDL_Vulkan_GetInstanceExtensions(window, &sdlExtensionCount, nullptr);
-		std::vector<const char*> extensions(sdlExtensionCount);
-		SDL_Vulkan_GetInstanceExtensions(window, &sdlExtensionCount, extensions.data());
+		std::vector<const char*> extensions;
+		// Surface extensions are only needed when there is a window to present to
+		if (!options.headless) {
+			unsigned sdlExtensionCount;
+			SDL_Vulkan_GetInstanceExtensions(window, &sdlExtensionCount, nullptr);
+			extensions.resize(sdlExtensionCount);
+			SDL_Vulkan_GetInstanceExtensions(window, &sdlExtensionCount, extensions.data());
+		}
 #ifdef ENABLE_VALIDATION_LAYERS
 		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 #endif
@@ -696,8 +1914,8 @@ private: // Private functions
 	bool isDeviceSuitable(VkPhysicalDevice device) const {
 		QueueFamilyIndices indices = findQueueFamilies(device);
 		bool extensionsSupported = checkDeviceExtensionSupport(device);
-		bool swapChainAdeqate = false;
-		if (extensionsSupported) {
+		bool swapChainAdeqate = options.headless;
+		if (extensionsSupported && !options.headless) {
 			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
 			swapChainAdeqate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
 		}
@@ -730,8 +1948,10 @@ private: // Private functions
 		for (const auto& queueFamily : queueFamilies) {
 			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
 				indices.graphicsFamily = i;
-				VkBool32 presentSupport;
-				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+				VkBool32 presentSupport = VK_TRUE; // Headless never presents, so the graphics family stands in
+				if (!options.headless) {
+					vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+				}
 				if (presentSupport) {
 					indices.presentFamily = i;
 				}
@@ -748,12 +1968,114 @@ private: // Private functions
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
-		std::set<std::string> requiredExtensions{ deviceExtensions.begin(), deviceExtensions.end() };
+		const auto& extensions = requiredDeviceExtensions();
+		std::set<std::string> requiredExtensions{ extensions.begin(), extensions.end() };
 		for (const auto& extension : availableExtensions) {
 			requiredExtensions.erase(extension.extensionName);
 		}
 		return requiredExtensions.empty();
 	}
+	// The swap chain extension is only required when presenting to a window
+	const std::vector<const char*>& requiredDeviceExtensions() const {
+		static const std::vector<const char*> headlessExtensions{};
+		return options.headless ? headlessExtensions : deviceExtensions;
+	}
+	std::optional<unsigned> tryFindMemoryType(unsigned typeFilter, VkMemoryPropertyFlags properties) const {
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+		for (unsigned i = 0; i < memProperties.memoryTypeCount; i++) {
+			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+				return i;
+			}
+		}
+		return std::nullopt;
+	}
+	unsigned findMemoryType(unsigned typeFilter, VkMemoryPropertyFlags properties) const {
+		auto memoryType = tryFindMemoryType(typeFilter, properties);
+		if (!memoryType.has_value()) {
+			throw std::runtime_error("failed to find suitable memory type");
+		}
+		return memoryType.value();
+	}
+	bool memoryTypeHasProperties(unsigned memoryType, VkMemoryPropertyFlags properties) const {
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+		return (memProperties.memoryTypes[memoryType].propertyFlags & properties) == properties;
+	}
+	// Checking the cache header against the selected device, see VkPipelineCacheHeaderVersionOne
+	bool isPipelineCacheCompatible(const std::vector<char>& cacheData) const {
+		if (cacheData.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+			return false;
+		}
+		VkPipelineCacheHeaderVersionOne header;
+		std::memcpy(&header, cacheData.data(), sizeof(header));
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+		return header.headerSize >= sizeof(header)
+			&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+			&& header.vendorID == deviceProperties.vendorID
+			&& header.deviceID == deviceProperties.deviceID
+			&& std::memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+	// Only called once the slot's fence has signaled, so the results are already there and reading them never stalls
+	void collectTimestamps(size_t slot) {
+		if (timestampQueryPools.empty() || !timestampsPending.at(slot)) {
+			return;
+		}
+		timestampsPending.at(slot) = false;
+		uint64_t timestamps[2];
+		if (vkGetQueryPoolResults(logicalDevice, timestampQueryPools.at(slot), 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+			renderPassTimes.push_back(((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriodMs);
+		}
+	}
+	void printRenderPassTimes() const {
+		if (renderPassTimes.empty()) {
+			return;
+		}
+		std::vector<double> sorted = renderPassTimes;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0.0;
+		for (double time : sorted) {
+			total += time;
+		}
+		std::cout << "GPU render pass: min " << sorted.front() << "ms, avg " << total / sorted.size()
+			<< "ms, p99 " << sorted.at((sorted.size() - 1) * 99 / 100) << "ms" << std::endl;
+	}
+	bool readbackEnabled() const {
+		return options.headless && options.readback;
+	}
+	bool gpuDriven() const {
+		return options.gpuDrivenObjects > 0;
+	}
+	bool instanced() const {
+		return options.instanceCount > 0;
+	}
+	// Of the circle around the origin that holds the whole mesh
+	float getMeshRadius() const {
+		float meshRadius = 0.0f;
+		for (const Vertex& vertex : vertices) {
+			meshRadius = std::max(meshRadius, glm::length(vertex.pos));
+		}
+		return meshRadius;
+	}
+	// Writing tightly packed R8G8B8A8 pixels out as a binary PPM, dropping the alpha channel
+	static void writeImage(const std::string& filename, const unsigned char* pixels, VkExtent2D extent) {
+		std::ofstream file(filename, std::ios::binary);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open file '" + filename + "'");
+		}
+		file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+		std::vector<char> row(static_cast<size_t>(extent.width) * 3);
+		for (unsigned y = 0; y < extent.height; y++) {
+			const unsigned char* src = pixels + static_cast<size_t>(y) * extent.width * 4;
+			for (unsigned x = 0; x < extent.width; x++) {
+				row[x * 3 + 0] = static_cast<char>(src[x * 4 + 0]);
+				row[x * 3 + 1] = static_cast<char>(src[x * 4 + 1]);
+				row[x * 3 + 2] = static_cast<char>(src[x * 4 + 2]);
+			}
+			file.write(row.data(), row.size());
+		}
+	}
 	SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device) const {
 		SwapChainSupportDetails details;
 		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
@@ -818,18 +2140,340 @@ private: // Private functions
 		file.close();
 		return buffer;
 	}
-	// Creating a shader module from the shader code
-	VkShaderModule createShaderModule(const std::vector<char>& code) {
+	// Mapping the archive written by AssetPacker and checking its header, the entries are checked as they are found
+	void openAssetArchive() {
+		if (options.assetArchivePath.empty() || !std::filesystem::exists(options.assetArchivePath)) {
+			return;
+		}
+		assetArchive = std::make_unique<MappedFile>(options.assetArchivePath);
+		const AssetArchiveHeader* header = static_cast<const AssetArchiveHeader*>(assetArchive->getData());
+		if (assetArchive->getSize() < sizeof(AssetArchiveHeader) || header->magic != ASSET_ARCHIVE_MAGIC || header->version != ASSET_ARCHIVE_VERSION ||
+			header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0 || header->indexSize > assetArchive->getSize() ||
+			sizeof(AssetArchiveHeader) + header->bucketCount * sizeof(AssetArchiveBucket) + uint64_t(header->entryCount) * sizeof(AssetArchiveEntry) > header->indexSize) {
+			throw std::runtime_error("'" + options.assetArchivePath + "' is not an asset archive");
+		}
+	}
+	// Looking the name up in the archive's hash table, nullptr when there is no archive or it does not hold the name
+	const AssetArchiveEntry* findAsset(const std::string& name) const {
+		if (!assetArchive) {
+			return nullptr;
+		}
+		const char* base = static_cast<const char*>(assetArchive->getData());
+		const AssetArchiveHeader* header = reinterpret_cast<const AssetArchiveHeader*>(base);
+		const AssetArchiveBucket* buckets = reinterpret_cast<const AssetArchiveBucket*>(header + 1);
+		const AssetArchiveEntry* entries = reinterpret_cast<const AssetArchiveEntry*>(buckets + header->bucketCount);
+		uint64_t hash = AssetNameHash(name.data(), name.size());
+		uint32_t mask = header->bucketCount - 1;
+		for (uint32_t i = static_cast<uint32_t>(hash) & mask, probes = 0; buckets[i] != 0 && probes < header->bucketCount; i = (i + 1) & mask, probes++) {
+			if (buckets[i] > header->entryCount) {
+				break;
+			}
+			const AssetArchiveEntry& entry = entries[buckets[i] - 1];
+			if (entry.nameHash == hash && entry.nameLength == name.size() && uint64_t(entry.nameOffset) + entry.nameLength <= header->indexSize &&
+				name.compare(0, name.size(), base + entry.nameOffset, entry.nameLength) == 0) {
+				if (entry.offset > assetArchive->getSize() || entry.size > assetArchive->getSize() - entry.offset) {
+					throw std::runtime_error("'" + name + "' lies outside the asset archive");
+				}
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+	// Taking the SPIR-V from the asset archive or mapping its file, then creating its module or reusing the module already made from identical code
+	VkShaderModule loadShaderModule(const std::string& filename) {
+		std::unique_ptr<MappedFile> file;
+		const uint32_t* code = nullptr;
+		size_t size = 0;
+		uint64_t hash = 0;
+		if (const AssetArchiveEntry* entry = findAsset(filename)) {
+			// Hashed by the packer, the pages holding the code are only read in to compare or create a module
+			code = reinterpret_cast<const uint32_t*>(static_cast<const char*>(assetArchive->getData()) + entry->offset);
+			size = entry->size;
+			hash = entry->contentHash;
+			archiveLoadCount++;
+		}
+		else {
+			file = std::make_unique<MappedFile>(filename);
+			code = static_cast<const uint32_t*>(file->getData());
+			size = file->getSize();
+			hash = AssetContentHash(code, size);
+		}
+		shaderLoadCount++;
+		auto [first, last] = shaderModules.equal_range(hash);
+		for (auto found = first; found != last; ++found) {
+			const std::vector<uint32_t>& cachedCode = found->second.code;
+			if (cachedCode.size() * sizeof(uint32_t) == size && memcmp(cachedCode.data(), code, size) == 0) {
+				return found->second.shaderModule;
+			}
+		}
+		if (size < sizeof(uint32_t) || size % sizeof(uint32_t) != 0 || code[0] != 0x07230203) {
+			throw std::runtime_error("'" + filename + "' is not SPIR-V");
+		}
+		// The driver copies the code, the mapping can go as soon as this returns
+		VkShaderModule shaderModule = createShaderModule(code, size);
+		shaderModules.emplace(hash, CachedShaderModule{ std::vector<uint32_t>(code, code + size / sizeof(uint32_t)), shaderModule });
+		return shaderModule;
+	}
+	VkShaderModule createShaderModule(const uint32_t* code, size_t size) const {
 		VkShaderModuleCreateInfo shaderModuleCreateInfo{};
 		shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		shaderModuleCreateInfo.codeSize = code.size();
-		shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+		shaderModuleCreateInfo.codeSize = size;
+		shaderModuleCreateInfo.pCode = code;
 		VkShaderModule shaderModule;
 		if (vkCreateShaderModule(logicalDevice, &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create shader module");
 		}
 		return shaderModule;
 	}
+	// Where the build puts the SPIR-V compiled from a source in res, shader.vert becomes vert.spv and the rest keep their name
+	static std::string compiledShaderPath(const std::string& source) {
+		if (source.rfind("shader.", 0) == 0) {
+			return "shaders/" + source.substr(7) + ".spv";
+		}
+		return "shaders/" + source + ".spv";
+	}
+	// Recording which module each shader in use resolves to and starting the thread that watches their sources
+	void startShaderWatcher() {
+		if (!std::filesystem::is_directory(options.hotReloadDirectory)) {
+			throw std::runtime_error("shader source directory '" + options.hotReloadDirectory + "' does not exist");
+		}
+		std::vector<std::string> paths = { vertexShaderPath(), "shaders/frag.spv" };
+		if (gpuDriven()) {
+			paths.push_back("shaders/cull.comp.spv");
+		}
+		if (instanced() && options.gpuAnimation) {
+			paths.push_back("shaders/animate.comp.spv");
+		}
+		for (const std::string& path : paths) {
+			watchedShaders[path] = loadShaderModule(path);
+		}
+		watchingShaders = true;
+		shaderWatcher = std::thread(&HelloTriangle::watchShaders, this);
+		std::cout << "Watching '" << options.hotReloadDirectory << "' for shader changes" << std::endl;
+	}
+	void stopShaderWatcher() {
+		if (!shaderWatcher.joinable()) {
+			return;
+		}
+		watchingShaders = false;
+		shaderWatcher.join();
+		// Pipelines still pending were never bound, and the device is idle for the retired ones
+		for (VkPipeline pipeline : { pendingReload.graphics, pendingReload.cull, pendingReload.animate }) {
+			vkDestroyPipeline(logicalDevice, pipeline, nullptr);
+		}
+		pendingReload = {};
+		for (const RetiredPipeline& retired : retiredPipelines) {
+			vkDestroyPipeline(logicalDevice, retired.pipeline, nullptr);
+		}
+		retiredPipelines.clear();
+		for (VkShaderModule shaderModule : reloadedShaderModules) {
+			vkDestroyShaderModule(logicalDevice, shaderModule, nullptr);
+		}
+		reloadedShaderModules.clear();
+	}
+	// Runs on the watcher thread, through inotify on Linux and by polling write times elsewhere
+	void watchShaders() {
+#ifdef __linux__
+		int watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		// Editors that save through a temporary file rename it into place, so moves count as writes
+		if (watcher < 0 || inotify_add_watch(watcher, options.hotReloadDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+			std::cerr << "failed to watch '" << options.hotReloadDirectory << "' for shader changes" << std::endl;
+			if (watcher >= 0) {
+				::close(watcher);
+			}
+			return;
+		}
+#else
+		std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes = getShaderSourceWriteTimes();
+#endif
+		while (watchingShaders) {
+			std::set<std::string> changed;
+#ifdef __linux__
+			pollfd watcherPoll{ watcher, POLLIN, 0 };
+			if (::poll(&watcherPoll, 1, 100) <= 0) {
+				continue;
+			}
+			// A save can arrive as several events, waiting a moment folds them into one reload
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			alignas(inotify_event) char buffer[4096];
+			ssize_t length;
+			while ((length = ::read(watcher, buffer, sizeof(buffer))) > 0) {
+				for (char* event = buffer; event < buffer + length;) {
+					const inotify_event* info = reinterpret_cast<const inotify_event*>(event);
+					if (info->len > 0) {
+						changed.insert(info->name);
+					}
+					event += sizeof(inotify_event) + info->len;
+				}
+			}
+#else
+			std::this_thread::sleep_for(std::chrono::milliseconds(250));
+			for (const auto& [source, writeTime] : getShaderSourceWriteTimes()) {
+				auto known = writeTimes.find(source);
+				if (known == writeTimes.end() || known->second != writeTime) {
+					changed.insert(source);
+					writeTimes[source] = writeTime;
+				}
+			}
+#endif
+			if (!changed.empty()) {
+				reloadShaders(changed);
+			}
+		}
+#ifdef __linux__
+		::close(watcher);
+#endif
+	}
+	std::unordered_map<std::string, std::filesystem::file_time_type> getShaderSourceWriteTimes() const {
+		std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(options.hotReloadDirectory, error)) {
+			if (entry.is_regular_file(error)) {
+				writeTimes[entry.path().filename().string()] = entry.last_write_time(error);
+			}
+		}
+		return writeTimes;
+	}
+	// Recompiling the changed sources in use and building only the pipelines made from them, then handing those to drawFrame.
+	// Any failure keeps the pipelines already running, a thrown exception would end the program from this thread
+	void reloadShaders(const std::set<std::string>& sources) {
+		bool graphics = false;
+		bool cull = false;
+		bool animate = false;
+		std::vector<VkShaderModule> superseded;
+		for (const std::string& source : sources) {
+			std::string compiledPath = compiledShaderPath(source);
+			auto watched = watchedShaders.find(compiledPath);
+			if (watched == watchedShaders.end()) {
+				continue;
+			}
+			auto compileStart = std::chrono::steady_clock::now();
+			VkShaderModule shaderModule = compileShader(options.hotReloadDirectory + "/" + source, compiledPath);
+			if (shaderModule == VK_NULL_HANDLE) {
+				continue;
+			}
+			std::chrono::duration<double, std::milli> compileTime = std::chrono::steady_clock::now() - compileStart;
+			std::cout << "Recompiled " << source << " in " << compileTime.count() << "ms" << std::endl;
+			// Modules loaded at startup belong to the shader module cache
+			auto owned = std::find(reloadedShaderModules.begin(), reloadedShaderModules.end(), watched->second);
+			if (owned != reloadedShaderModules.end()) {
+				superseded.push_back(watched->second);
+				reloadedShaderModules.erase(owned);
+			}
+			watched->second = shaderModule;
+			reloadedShaderModules.push_back(shaderModule);
+			graphics |= compiledPath == vertexShaderPath() || compiledPath == "shaders/frag.spv";
+			cull |= compiledPath == "shaders/cull.comp.spv";
+			animate |= compiledPath == "shaders/animate.comp.spv";
+		}
+		ReloadedPipelines rebuilt;
+		try {
+			if (graphics) {
+				rebuilt.graphics = buildGraphicsPipeline(watchedShaders.at(vertexShaderPath()), watchedShaders.at("shaders/frag.spv"));
+			}
+			if (cull) {
+				rebuilt.cull = buildComputePipeline(watchedShaders.at("shaders/cull.comp.spv"));
+			}
+			if (animate) {
+				rebuilt.animate = buildComputePipeline(watchedShaders.at("shaders/animate.comp.spv"));
+			}
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+		}
+		// Pipelines keep what they need from their modules, so replaced modules can go now
+		for (VkShaderModule shaderModule : superseded) {
+			vkDestroyShaderModule(logicalDevice, shaderModule, nullptr);
+		}
+		std::lock_guard<std::mutex> lock(reloadMutex);
+		// A newer build replaces one drawFrame has not picked up yet, which was never bound
+		std::pair<VkPipeline*, VkPipeline> results[] = { { &pendingReload.graphics, rebuilt.graphics }, { &pendingReload.cull, rebuilt.cull }, { &pendingReload.animate, rebuilt.animate } };
+		for (auto [pending, pipeline] : results) {
+			if (pipeline != VK_NULL_HANDLE) {
+				vkDestroyPipeline(logicalDevice, *pending, nullptr);
+				*pending = pipeline;
+			}
+		}
+	}
+	// Compiling with the glslc the build uses, its errors go straight to the console. Returns VK_NULL_HANDLE when the source does not compile
+	VkShaderModule compileShader(const std::string& sourcePath, const std::string& compiledPath) const {
+		std::string outputPath = compiledPath + ".reload";
+		std::string command = "glslc \"" + sourcePath + "\" -o \"" + outputPath + "\"";
+		if (std::system(command.c_str()) != 0) {
+			std::cerr << "keeping the running pipelines, '" << sourcePath << "' did not compile" << std::endl;
+			return VK_NULL_HANDLE;
+		}
+		try {
+			std::vector<char> code = readFile(outputPath);
+			std::filesystem::remove(outputPath);
+			if (code.size() < sizeof(uint32_t) || code.size() % sizeof(uint32_t) != 0) {
+				throw std::runtime_error("'" + outputPath + "' is not SPIR-V");
+			}
+			return createShaderModule(reinterpret_cast<const uint32_t*>(code.data()), code.size());
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+			return VK_NULL_HANDLE;
+		}
+	}
+	// Swapping in pipelines the watcher finished at a frame boundary, the render loop never waits on the watcher
+	void applyShaderReload() {
+		destroyRetiredPipelines();
+		std::unique_lock<std::mutex> lock(reloadMutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			return;
+		}
+		ReloadedPipelines reloaded = pendingReload;
+		pendingReload = {};
+		lock.unlock();
+		std::pair<VkPipeline*, VkPipeline> swaps[] = { { &graphicsPipeline, reloaded.graphics }, { &cullPipeline, reloaded.cull }, { &animatePipeline, reloaded.animate } };
+		for (auto [current, pipeline] : swaps) {
+			if (pipeline != VK_NULL_HANDLE) {
+				// Frames already submitted may still be using the old one
+				retiredPipelines.push_back({ *current, frameNumber });
+				*current = pipeline;
+				pipelineGeneration++;
+			}
+		}
+	}
+	// Every frame slot's fence has been waited on since a pipeline was retired once framesInFlight frames have passed
+	void destroyRetiredPipelines() {
+		while (!retiredPipelines.empty() && frameNumber >= retiredPipelines.front().retiredAt + options.framesInFlight) {
+			vkDestroyPipeline(logicalDevice, retiredPipelines.front().pipeline, nullptr);
+			retiredPipelines.pop_front();
+		}
+	}
+	// Clears the draw count, culls every object into this slot's draw buffer and makes the results visible to the indirect draw
+	void recordCulling(VkCommandBuffer commandBuffer) const {
+		vkCmdFillBuffer(commandBuffer, drawCountBuffers.at(currentFrame), 0, sizeof(uint32_t), 0);
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &cullDescriptorSets.at(currentFrame), 0, nullptr);
+		vkCmdDispatch(commandBuffer, static_cast<unsigned>((options.gpuDrivenObjects + 63) / 64), 1, 1);
+
+		VkMemoryBarrier cullBarrier{};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+	}
+	// Writes this slot's instance positions and makes them visible to vertex input
+	void recordAnimation(VkCommandBuffer commandBuffer) const {
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, animatePipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &animateDescriptorSets.at(currentFrame), 0, nullptr);
+		vkCmdDispatch(commandBuffer, static_cast<unsigned>((options.instanceCount + 63) / 64), 1, 1);
+
+		VkMemoryBarrier animateBarrier{};
+		animateBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		animateBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		animateBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &animateBarrier, 0, nullptr, 0, nullptr);
+	}
 	void recordCommandBuffer(VkCommandBuffer commandBuffer, unsigned imageIndex) const {
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -837,6 +2481,17 @@ private: // Private functions
 		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
 			throw std::runtime_error("failed to begin recording command buffer");
 		}
+		VkQueryPool timestampQueryPool = timestampQueryPools.empty() ? VK_NULL_HANDLE : timestampQueryPools.at(currentFrame);
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 0, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 0);
+		}
+		if (gpuDriven()) {
+			recordCulling(commandBuffer);
+		}
+		if (instanced() && options.gpuAnimation) {
+			recordAnimation(commandBuffer);
+		}
 
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -868,9 +2523,59 @@ private: // Private functions
 		scissor.extent = swapChainExtent;
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		VkBuffer vertexBuffers[] = { vertexBuffer };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+		if (gpuDriven()) {
+			// The same handful of calls whatever the object count, the GPU decides how many draws there are
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &cullDescriptorSets.at(currentFrame), 0, nullptr);
+			vkCmdDrawIndexedIndirectCount(commandBuffer, drawCommandBuffers.at(currentFrame), 0, drawCountBuffers.at(currentFrame), 0,
+				static_cast<unsigned>(options.gpuDrivenObjects), sizeof(VkDrawIndexedIndirectCommand));
+		}
+		else if (instanced()) {
+			VkBuffer instanceBuffers[] = { instancePositionBuffers.at(currentFrame), instanceColorBuffer };
+			VkDeviceSize instanceOffsets[] = { 0, 0 };
+			vkCmdBindVertexBuffers(commandBuffer, 1, 2, instanceBuffers, instanceOffsets);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float), &instanceScale);
+			vkCmdDrawIndexed(commandBuffer, static_cast<unsigned>(indices.size()), static_cast<unsigned>(options.instanceCount), 0, 0, 0);
+		}
+		else {
+			vkCmdDrawIndexed(commandBuffer, static_cast<unsigned>(indices.size()), 1, 0, 0, 0);
+		}
 
 		vkCmdEndRenderPass(commandBuffer);
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, 1);
+		}
+
+		if (readbackEnabled()) {
+			// The render pass left the target in TRANSFER_SRC_OPTIMAL, copy it out tightly packed
+			VkBufferImageCopy region{};
+			region.bufferOffset = 0;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = 0;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { swapChainExtent.width, swapChainExtent.height, 1 };
+			vkCmdCopyImageToBuffer(commandBuffer, swapChainImages.at(imageIndex), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffers.at(imageIndex), 1, &region);
+
+			// Making the copy visible to host reads once the fence signals
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = readbackBuffers.at(imageIndex);
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
 
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
 			throw std::runtime_error("failed to record command buffer");
@@ -879,8 +2584,51 @@ private: // Private functions
 #pragma endregion
 };
 
-int main() {
-	HelloTriangle app;
+int main(int argc, char** argv) {
+	HelloTriangleOptions options;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--headless") {
+			options.headless = true;
+		}
+		else if (arg == "--frames" && i + 1 < argc) {
+			options.frameCount = std::stoul(argv[++i]);
+		}
+		else if (arg == "--readback") {
+			options.readback = true;
+		}
+		else if (arg == "--dump" && i + 1 < argc) {
+			options.readback = true;
+			options.dumpPath = argv[++i];
+		}
+		else if (arg == "--stress" && i + 1 < argc) {
+			options.stressTriangles = std::stoul(argv[++i]);
+		}
+		else if (arg == "--gpu-driven" && i + 1 < argc) {
+			options.gpuDrivenObjects = std::stoul(argv[++i]);
+		}
+		else if (arg == "--instances" && i + 1 < argc) {
+			options.instanceCount = std::stoul(argv[++i]);
+		}
+		else if (arg == "--gpu-animation") {
+			options.gpuAnimation = true;
+		}
+		else if (arg == "--static-commands") {
+			options.staticCommands = true;
+		}
+		else if (arg == "--hot-reload" && i + 1 < argc) {
+			options.hotReloadDirectory = argv[++i];
+		}
+		else if (arg == "--frames-in-flight" && i + 1 < argc) {
+			size_t framesInFlight = std::stoul(argv[++i]);
+			options.framesInFlight = framesInFlight < 1 ? 1 : framesInFlight > MAX_FRAMES_IN_FLIGHT ? MAX_FRAMES_IN_FLIGHT : framesInFlight;
+		}
+	}
+	if (options.instanceCount > 0 && options.gpuDrivenObjects > 0) {
+		std::cerr << "--instances and --gpu-driven are separate workloads, pick one" << std::endl;
+		return EXIT_FAILURE;
+	}
+	HelloTriangle app(options);
 	try {
 		app.run();
 	}
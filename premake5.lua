@@ -2,6 +2,10 @@ workspace "Vulkan"
 	architecture "x64"
 	configurations {"Debug", "Release"}
 
+	include "AssetPacker"
+
 	include "HelloTriangle"
 
 	include "AppFramework"
+
+	include "Benchmarks"